@@ -0,0 +1,185 @@
+/**
+ * @file DigitAtlasBench.cpp
+ * @author Christoper B. Liebman
+ * @brief host benchmark, score digits via DigitAtlas vs per pixel drawing
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ * Build and run on the host:
+ *
+ *   g++ -std=gnu++11 -O2 -Ilib/NativeHal/src -Isrc -Iinclude bench/DigitAtlasBench.cpp src/DigitAtlas.cpp -o digit_bench
+ *   ./digit_bench [frames]
+ *
+ * The "gfx" path mirrors what Adafruit_GFX does for a custom font through
+ * Framebuffer_GFX: getTextBounds("00") for the size, a snprintf for "%02d"
+ * and a virtual drawPixel() (bounds check and 565 to RGB expansion) for
+ * every set bit.  Both paths draw the two scores of a frame into the same
+ * 64x32 RGB buffer and must produce identical pixels.
+ */
+
+#include "gfxfont.h"
+#include "GFXFonts/br2_serif_score_23.h"
+#include "DigitAtlas.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int WIDTH  = 64;
+static const int HEIGHT = 32;
+
+struct RGB
+{
+    uint8_t r, g, b;
+    RGB() : r(0), g(0), b(0) {}
+    RGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) {}
+};
+
+class PixelTarget
+{
+public:
+    virtual ~PixelTarget() {}
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+};
+
+class Framebuffer : public PixelTarget
+{
+public:
+    explicit Framebuffer(RGB* fb) : _fb(fb) {}
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override
+    {
+        if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT)
+        {
+            return;
+        }
+        _fb[y * WIDTH + x] = RGB((color >> 8) & 0xf8, (color >> 3) & 0xfc, (color << 3) & 0xf8);
+    }
+
+private:
+    RGB* _fb;
+};
+
+static void gfxTextBounds(const GFXfont* font, const char* text, uint16_t* w)
+{
+    int minx = 0x7fff, maxx = -1, x = 0;
+    for (; *text; ++text)
+    {
+        const GFXglyph& g = font->glyph[*text - font->first];
+        if (x + g.xOffset < minx) minx = x + g.xOffset;
+        if (x + g.xOffset + g.width - 1 > maxx) maxx = x + g.xOffset + g.width - 1;
+        x += g.xAdvance;
+    }
+    *w = maxx - minx + 1;
+}
+
+static void gfxDrawChar(PixelTarget& target, const GFXfont* font, int16_t x, int16_t y, char c, uint16_t color)
+{
+    const GFXglyph& g = font->glyph[c - font->first];
+    const uint8_t* bitmap = font->bitmap;
+    uint16_t bo = g.bitmapOffset;
+    uint8_t bits = 0, bit = 0;
+    for (int yy = 0; yy < g.height; yy++)
+    {
+        for (int xx = 0; xx < g.width; xx++)
+        {
+            if (!(bit++ & 7))
+            {
+                bits = bitmap[bo++];
+            }
+            if (bits & 0x80)
+            {
+                target.drawPixel(x + g.xOffset + xx, y + g.yOffset + yy, color);
+            }
+            bits <<= 1;
+        }
+    }
+}
+
+static void gfxDrawSide(PixelTarget& target, int16_t x, int16_t y, int value)
+{
+    uint16_t w;
+    gfxTextBounds(&br2_serif_score_23, "00", &w);
+    char text[8];
+    snprintf(text, sizeof(text), "%02d", value);
+    for (const char* c = text; *c; ++c)
+    {
+        gfxDrawChar(target, &br2_serif_score_23, x, y, *c, 0xffff);
+        x += br2_serif_score_23.glyph[*c - '0'].xAdvance;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    typedef std::chrono::steady_clock Clock;
+    long frames = argc > 1 ? atol(argv[1]) : 200000;
+
+    static RGB gfx_fb[WIDTH * HEIGHT];
+    static RGB atlas_fb[WIDTH * HEIGHT];
+    Framebuffer target(gfx_fb);
+    DigitAtlas digits;
+    if (!digits.build(&br2_serif_score_23))
+    {
+        printf("atlas build failed\n");
+        return 1;
+    }
+    const RGB white(0xf8, 0xfc, 0xf8);   // what 0xffff expands to
+    const int y = HEIGHT - 3;
+
+    // same pixels for every score, past 99 the atlas shows 99
+    for (int value = 0; value <= 127; ++value)
+    {
+        std::fill(gfx_fb, gfx_fb + WIDTH * HEIGHT, RGB());
+        std::fill(atlas_fb, atlas_fb + WIDTH * HEIGHT, RGB());
+        gfxDrawSide(target, 2, y, value > 99 ? 99 : value);
+        digits.blit2(atlas_fb, WIDTH, HEIGHT, 2, y, value, white);
+        if (memcmp(gfx_fb, atlas_fb, sizeof(gfx_fb)) != 0)
+        {
+            printf("pixel mismatch for %02d\n", value);
+            return 1;
+        }
+    }
+
+    Clock::time_point start = Clock::now();
+    for (long i = 0; i < frames; ++i)
+    {
+        gfxDrawSide(target, 2, y, i % 100);
+        gfxDrawSide(target, 40, y, (i / 3) % 100);
+    }
+    double gfx_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / frames;
+
+    start = Clock::now();
+    for (long i = 0; i < frames; ++i)
+    {
+        digits.blit2(atlas_fb, WIDTH, HEIGHT, 2, y, i % 100, white);
+        digits.blit2(atlas_fb, WIDTH, HEIGHT, 40, y, (i / 3) % 100, white);
+    }
+    double atlas_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / frames;
+
+    printf("frames:          %ld (two scores each)\n", frames);
+    printf("gfx per frame:   %.0f ns\n", gfx_ns);
+    printf("atlas per frame: %.0f ns\n", atlas_ns);
+    printf("speedup:         %.1fx\n", gfx_ns / atlas_ns);
+    return 0;
+}
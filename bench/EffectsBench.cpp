@@ -0,0 +1,159 @@
+/**
+ * @file EffectsBench.cpp
+ * @author Christoper B. Liebman
+ * @brief host benchmark, twinkle via EffectEngine vs random() and drawPixel()
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ * Build and run on the host:
+ *
+ *   g++ -std=gnu++11 -O2 -Isrc bench/EffectsBench.cpp -o effects_bench
+ *   ./effects_bench [frames]
+ *
+ * The "gfx" path mirrors the old doTwinkle(): two random() calls per pixel
+ * (a modulo of a library PRNG standing in for esp_random()) and a virtual
+ * drawPixel() with bounds check and 565 to RGB expansion.  Each frame is
+ * the CHOOSING effect, red and blue twinkles over the whole 64x32 panel.
+ */
+#include "EffectEngine.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const int WIDTH  = 64;
+static const int HEIGHT = 32;
+
+struct RGB
+{
+    uint8_t r, g, b;
+    RGB() : r(0), g(0), b(0) {}
+    RGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) {}
+};
+
+class PixelTarget
+{
+public:
+    virtual ~PixelTarget() {}
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+};
+
+class Framebuffer : public PixelTarget
+{
+public:
+    explicit Framebuffer(RGB* fb) : _fb(fb) {}
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override
+    {
+        if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT)
+        {
+            return;
+        }
+        _fb[y * WIDTH + x] = RGB((color >> 8) & 0xf8, (color >> 3) & 0xfc, (color << 3) & 0xf8);
+    }
+
+private:
+    RGB* _fb;
+};
+
+static long arduinoRandom(long howbig)
+{
+    return random() % howbig;
+}
+
+static uint16_t color565(uint8_t r, uint8_t g, uint8_t b)
+{
+    return ((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3);
+}
+
+static void gfxTwinkle(PixelTarget& target, int x, int y, int width, int height, uint8_t r, uint8_t g, uint8_t b, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        target.drawPixel(x + arduinoRandom(width), y + arduinoRandom(height), color565(r, g, b));
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        target.drawPixel(x + arduinoRandom(width), y + arduinoRandom(height), 0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    typedef std::chrono::steady_clock Clock;
+    long frames = argc > 1 ? atol(argv[1]) : 200000;
+    const size_t count = 16 + 32;      // CHOOSING: width + height of the middle
+
+    static RGB gfx_fb[WIDTH * HEIGHT];
+    static RGB engine_fb[WIDTH * HEIGHT];
+    Framebuffer  target(gfx_fb);
+    EffectEngine engine;
+
+    // every pixel stays inside the rectangle and both colors show up
+    engine.twinkle(engine_fb, WIDTH, 10, 4, 20, 8, RGB(255, 0, 0), 100000);
+    engine.twinkle(engine_fb, WIDTH, 10, 4, 20, 8, RGB(0, 0, 255), 100);
+    size_t on = 0;
+    for (int y = 0; y < HEIGHT; ++y)
+    {
+        for (int x = 0; x < WIDTH; ++x)
+        {
+            const RGB& p = engine_fb[y * WIDTH + x];
+            bool inside = x >= 10 && x < 30 && y >= 4 && y < 12;
+            if (!inside && (p.r || p.b))
+            {
+                printf("pixel outside the rectangle at %d,%d\n", x, y);
+                return 1;
+            }
+            on += p.b != 0;
+        }
+    }
+    if (on == 0)
+    {
+        printf("no pixels drawn\n");
+        return 1;
+    }
+
+    Clock::time_point start = Clock::now();
+    for (long i = 0; i < frames; ++i)
+    {
+        gfxTwinkle(target, 0, 0, WIDTH, HEIGHT, i & 0xff, 0, 0, count);
+        gfxTwinkle(target, 0, 0, WIDTH, HEIGHT, 0, 0, i & 0xff, count);
+    }
+    double gfx_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (long i = 0; i < frames; ++i)
+    {
+        engine.twinkle(engine_fb, WIDTH, 0, 0, WIDTH, HEIGHT, RGB(i & 0xff, 0, 0), count);
+        engine.twinkle(engine_fb, WIDTH, 0, 0, WIDTH, HEIGHT, RGB(0, 0, i & 0xff), count);
+    }
+    double engine_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    // four passes of count pixels each per frame
+    double pixels = 4.0 * count * frames;
+    printf("frames:           %ld (%zu pixels each)\n", frames, 4 * count);
+    printf("gfx pixels/us:    %.1f\n", pixels / gfx_us);
+    printf("engine pixels/us: %.1f\n", pixels / engine_us);
+    printf("speedup:          %.1fx\n", gfx_us / engine_us);
+    printf("checksum:         %d\n", gfx_fb[5].r + engine_fb[5].r + engine_fb[7].b);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file EventBusBench.cpp
+ * @author Christoper B. Liebman
+ * @brief host benchmark of EventChannel against the old std::function callbacks
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ *
+ * Build and run on the host:
+ *
+ *   g++ -std=gnu++11 -O2 -Isrc bench/EventBusBench.cpp -o event_bus_bench
+ *   ./event_bus_bench [events]
+ *
+ * The "function" path mirrors the old App::changeNotify(): a
+ * std::vector<std::function> filled with std::bind results and walked by
+ * value, so each callback is copied on every notification.  The "channel"
+ * path is an EventChannel of Delegates with the subscription filters the
+ * App uses.  Both notify the same three subscribers (Display, ScoreJournal
+ * and WebApp), the WebApp skips limit changes either way.
+ */
+#include "EventBus.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static std::atomic<uint64_t> allocations(0);
+
+void* operator new(size_t size)
+{
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+#define CHANGE_SCORE    (1 << 0)
+#define CHANGE_LIMITS   (1 << 3)
+
+// what ScoreChanged carries, without the App
+struct Changed
+{
+    uint32_t version;
+    uint32_t changes;
+    uint32_t score;
+    uint32_t match;
+    uint32_t filterMask() const { return changes; }
+};
+
+class Subscriber
+{
+public:
+    explicit Subscriber(uint32_t skip) : _skip(skip), _seen(0) {}
+
+    // the old callback, it filtered for itself
+    void onChange(uint32_t version, uint32_t changes)
+    {
+        if ((changes & ~_skip) != 0)
+        {
+            _seen += version;
+        }
+    }
+
+    void changed(const Changed& event)
+    {
+        _seen += event.version;
+    }
+
+    uint64_t seen() const { return _seen; }
+
+private:
+    uint32_t _skip;
+    uint64_t _seen;
+};
+
+using ChangeCB = std::function<void(uint32_t version, uint32_t changes)>;
+
+int main(int argc, char** argv)
+{
+    typedef std::chrono::steady_clock Clock;
+    long events = argc > 1 ? atol(argv[1]) : 10000000;
+
+    Subscriber display(0), journal(0), web(CHANGE_LIMITS);
+    Subscriber* subscribers[] = {&display, &journal, &web};
+    uint32_t    filters[]     = {EVENT_FILTER_ALL, EVENT_FILTER_ALL, (uint32_t)~CHANGE_LIMITS};
+
+    std::vector<ChangeCB> callbacks;
+    EventChannel<Changed, 4> channel;
+    for (int i = 0; i < 3; ++i)
+    {
+        callbacks.push_back(std::bind(&Subscriber::onChange, subscribers[i], std::placeholders::_1, std::placeholders::_2));
+        channel.subscribe(Delegate<Changed>::bind<Subscriber, &Subscriber::changed>(subscribers[i]), filters[i]);
+    }
+
+    // one change in eight is a limit change
+    uint64_t before = allocations;
+    Clock::time_point start = Clock::now();
+    for (long i = 0; i < events; ++i)
+    {
+        uint32_t changes = (i & 7) ? CHANGE_SCORE : CHANGE_LIMITS;
+        for (ChangeCB cb : callbacks)
+        {
+            cb(i, changes);
+        }
+    }
+    double   function_ns     = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    uint64_t function_allocs = allocations - before;
+    uint64_t function_seen   = display.seen() + journal.seen() + web.seen();
+
+    before = allocations;
+    start  = Clock::now();
+    for (long i = 0; i < events; ++i)
+    {
+        uint32_t changes = (i & 7) ? CHANGE_SCORE : CHANGE_LIMITS;
+        channel.publish(Changed{(uint32_t)i, changes, 0, 0});
+    }
+    double   channel_ns     = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    uint64_t channel_allocs = allocations - before;
+    uint64_t channel_seen   = display.seen() + journal.seen() + web.seen() - function_seen;
+
+    if (channel_seen != function_seen)
+    {
+        printf("subscribers saw different events: %llu vs %llu\n",
+               (unsigned long long)function_seen, (unsigned long long)channel_seen);
+        return 1;
+    }
+    printf("events:              %ld to 3 subscribers\n", events);
+    printf("function ns/event:   %.1f (%llu allocations)\n", function_ns / events, (unsigned long long)function_allocs);
+    printf("channel ns/event:    %.1f (%llu allocations)\n", channel_ns / events, (unsigned long long)channel_allocs);
+    printf("speedup:             %.1fx\n", function_ns / channel_ns);
+    return 0;
+}
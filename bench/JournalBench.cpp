@@ -0,0 +1,104 @@
+/**
+ * @file JournalBench.cpp
+ * @author Christoper B. Liebman
+ * @brief host benchmark for the Journal write path
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ * Build and run on the host:
+ *
+ *   g++ -std=gnu++11 -O2 -Isrc bench/JournalBench.cpp src/Journal.cpp -o journal_bench
+ *   ./journal_bench [records] [path]
+ *
+ * Commits go to a real file with fsync() so the numbers include the storage
+ * latency of the host, use them to compare changes not to predict flash.
+ */
+
+#include "Journal.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+class FileJournalStore : public JournalStore
+{
+public:
+    explicit FileJournalStore(const char* path) : _path(path), _fd(open(path, O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0644)) {}
+    ~FileJournalStore() { close(_fd); }
+    size_t size() override { return lseek(_fd, 0, SEEK_END); }
+    size_t read(size_t offset, uint8_t* data, size_t len) override { ssize_t n = pread(_fd, data, len, offset); return n < 0 ? 0 : n; }
+    bool   append(const uint8_t* data, size_t len) override { return write(_fd, data, len) == (ssize_t)len; }
+    bool   sync() override { return fsync(_fd) == 0; }
+    bool   rewrite(const uint8_t* data, size_t len) override
+    {
+        return ftruncate(_fd, 0) == 0 && (len == 0 || append(data, len)) && sync();
+    }
+
+private:
+    const char* _path;
+    int         _fd;
+};
+
+int main(int argc, char** argv)
+{
+    typedef std::chrono::steady_clock Clock;
+    long        count = argc > 1 ? atol(argv[1]) : 100000;
+    const char* path  = argc > 2 ? argv[2] : "journal_bench.bin";
+
+    FileJournalStore store(path);
+    Journal journal(store);
+
+    double worst_us = 0;
+    Clock::time_point start = Clock::now();
+    for (long i = 0; i < count; ++i)
+    {
+        // a commit happens inside append() when the batch fills
+        Clock::time_point before = Clock::now();
+        journal.append((uint32_t)i, (uint32_t)(i >> 4));
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - before).count();
+        if (us > worst_us)
+        {
+            worst_us = us;
+        }
+    }
+    journal.commit();
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+    JournalRecord last;
+    Journal reload(store);
+    Clock::time_point load_start = Clock::now();
+    bool found = reload.load(last);
+    double load_us = std::chrono::duration<double, std::micro>(Clock::now() - load_start).count();
+
+    printf("records:        %ld\n", count);
+    printf("records/sec:    %.0f\n", count / secs);
+    printf("commits:        %u (batch %d)\n", journal.commits(), JOURNAL_BATCH_SIZE);
+    printf("compactions:    %u (every %d records)\n", journal.compactions(), JOURNAL_COMPACT_RECORDS);
+    printf("worst commit:   %.1f us\n", worst_us);
+    printf("reload:         %s %u records in %.1f us, last score %u\n",
+           found ? "ok" : "FAILED", (unsigned)reload.records(), load_us, found ? last.score : 0);
+    unlink(path);
+    return found && last.score == (uint32_t)(count - 1) ? 0 : 1;
+}
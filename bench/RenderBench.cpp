@@ -0,0 +1,421 @@
+/**
+ * @file RenderBench.cpp
+ * @author Christoper B. Liebman
+ * @brief host benchmark of each Display render path per AppMode
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ *
+ * Build and run on the host from the top of the repo:
+ *
+ *   pio run -e native_render_bench
+ *   .pio/build/native_render_bench/program [compare|record] [baseline file]
+ *
+ * The App and Display run on the NativeHal virtual clock with a
+ * FrameBufferTarget.  The App is stepped through each mode and in each the
+ * render paths are called directly on this thread, one benchmark per path:
+ * the full doRender(), the scoreboard and game over scene updates,
+ * drawChoices(), animate() and a whole frame (animate, overlays and show).
+ * Each reports the host time per call (the fastest of several repeats),
+ * the pixels one call writes (the back buffer is filled with a color
+ * nothing draws and the survivors counted) and heap allocations per call.
+ *
+ * "compare" (the default) prints the change against
+ * bench/render_baseline.txt, "record" rewrites it.  Times only compare on
+ * the same machine and build, pixels and allocations compare anywhere.
+ */
+#include <Arduino.h>
+#include <NativeHal.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <new>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "App.h"
+#include "Display.h"
+#include "FrameBufferTarget.h"
+#include "Log.h"
+
+DLog& dlog = DLog::getLog();
+
+#define BENCH_REPEATS   5           // time each benchmark this many times, report the fastest
+#define BENCH_MIN_NS    40000000    // and each time run it at least this long
+#define BENCH_FRAME_US  33333       // elapsed time handed to animate()
+#define BENCH_WIDTH     64
+#define BENCH_HEIGHT    32
+
+static std::atomic<uint64_t> allocations(0);
+
+void* operator new(size_t size)
+{
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+struct BenchResult
+{
+    std::string name;
+    double      ns;
+    uint32_t    pixels;
+    double      allocs;
+};
+
+class RenderBench
+{
+public:
+    RenderBench(App& app, const char* mode, const char* path)
+    : _app(app),
+      _target(BENCH_WIDTH, BENCH_HEIGHT),
+      _display(app, _target),
+      _mode(mode),
+      _path(path),
+      _task(nullptr),
+      _saved(),
+      _results()
+    {
+    }
+
+    void begin()
+    {
+        _app.begin();
+        _display.begin("Scoreboard 1.0");
+        _app.events().subscribe(Delegate<ScoreChanged>::bind<Display, &Display::changed>(&_display),
+                                CHANGE_ALL & ~CHANGE_LIMITS);
+        xTaskCreatePinnedToCore(&taskGateway<RenderBench>, "Bench", 8192, this, 1, &_task, 1);
+    }
+
+private:
+    App&                     _app;
+    FrameBufferTarget        _target;
+    Display                  _display;
+    std::string              _mode;
+    std::string              _path;
+    TaskHandle_t             _task;
+    CRGB                     _saved[BENCH_WIDTH * BENCH_HEIGHT];
+    std::vector<BenchResult> _results;
+
+    void script()
+    {
+        settle(500);
+
+        Display& d = _display;
+        Scene    scene;
+
+        // STARTING, the splash scrolls and twinkles
+        bench("starting/render", [&] { d._no_clear = false; d.doRender(); });
+        bench("starting/animate", [&] { d.animate(BENCH_FRAME_US); });
+        bench("starting/frame", [&] { frame(); });
+
+        // CHOOSING
+        _app.started();
+        waitMode(AppMode::CHOOSING);
+        bench("choosing/render", [&] { d._no_clear = false; d.doRender(); });
+        bench("choosing/drawChoices", [&] { d.drawChoices(_app.snapshot()); });
+        bench("choosing/animate", [&] { d.animate(BENCH_FRAME_US); });
+        bench("choosing/frame", [&] { frame(); });
+
+        // RUNNING, scene updates alternate between two states so each call repaints
+        _app.setFormat(FORMAT_BADMINTON_21);
+        waitMode(AppMode::RUNNING);
+        points(Score::LHS, 7);
+        points(Score::RHS, 3);
+        Score::State before = _app.snapshot();
+        points(Score::LHS, 1);
+        Score::State point = _app.snapshot();
+        _app.swap();
+        settle(100);
+        Score::State swapped = _app.snapshot();
+        int flip = 0;
+        bench("running/render", [&] { d._no_clear = false; d.doRender(); });
+        bench("running/render_unchanged", [&] { d._no_clear = true; d.doRender(); });
+        // the first call is the one counted, it must diff against the other state
+        drawScoreboard(scene, before);
+        bench("running/scoreboard_point", [&] {
+            scene.clear();
+            d.buildScoreboard(scene, ++flip & 1 ? point : before);
+            d.drawScene(scene, false);
+        });
+        drawScoreboard(scene, point);
+        flip = 0;
+        bench("running/scoreboard_swap", [&] {
+            scene.clear();
+            d.buildScoreboard(scene, ++flip & 1 ? swapped : point);
+            d.drawScene(scene, false);
+        });
+        bench("running/animate", [&] { d.animate(BENCH_FRAME_US); });
+        bench("running/frame", [&] { frame(); });
+        d.overlay("Hello", 0);
+        settle(100);
+        bench("running/frame_overlay", [&] { frame(); });
+        d.post(DISPLAY_END_MESSAGES);
+        settle(100);
+        d._stats.setOverlay(true);
+        bench("running/frame_stats", [&] { frame(); });
+        d._stats.setOverlay(false);
+        settle(100);
+
+        // GAME_OVER, the blink only moves the box
+        points(Score::RHS, 14);
+        waitMode(AppMode::GAME_OVER);
+        Score::State over = _app.snapshot();
+        bench("game_over/render", [&] { d._no_clear = false; d.doRender(); });
+        bench("game_over/blink", [&] {
+            d._blink_state = !d._blink_state;
+            scene.clear();
+            d.buildScoreboard(scene, over);
+            d.buildGameOver(scene, over);
+            d.drawScene(scene, false);
+        });
+        bench("game_over/animate", [&] { d.animate(BENCH_FRAME_US); });
+        bench("game_over/frame", [&] { frame(); });
+    }
+
+    // let the App and Display tasks catch up
+    void settle(uint32_t ms)
+    {
+        vTaskDelay(ms / portTICK_PERIOD_MS);
+    }
+
+    void waitMode(AppMode mode)
+    {
+        while (_app.mode() != mode)
+        {
+            settle(10);
+        }
+        settle(100);
+    }
+
+    void points(Score::Side side, int count)
+    {
+        while (count-- > 0)
+        {
+            _app.incrementScore(side, 1);
+        }
+        settle(100);
+    }
+
+    // retain a scoreboard so the next diffed draw starts from it
+    void drawScoreboard(Scene& scene, const Score::State& state)
+    {
+        scene.clear();
+        _display.buildScoreboard(scene, state);
+        _display.drawScene(scene, false);
+    }
+
+    // one pass of the Display task's frame after any render
+    void frame()
+    {
+        _display.animate(BENCH_FRAME_US);
+        _display.drawOverlay();
+        _display.drawStats();
+        _target.show();
+    }
+
+    // pixels one call writes: whatever no longer holds a color nothing draws
+    uint32_t pixels(const std::function<void()>& fn)
+    {
+        static const CRGB marker(1, 2, 3);
+        static const size_t count = BENCH_WIDTH * BENCH_HEIGHT;
+        memcpy(_saved, _target.backBuffer(), sizeof(_saved));
+        _display._engine.seed(1);   // the same twinkles whatever ran before
+        for (size_t i = 0; i < count; ++i)
+        {
+            _target.backBuffer()[i] = marker;
+        }
+        fn();
+        uint32_t written = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            written += _target.backBuffer()[i] != marker;
+        }
+        memcpy(_target.backBuffer(), _saved, sizeof(_saved));
+        return written;
+    }
+
+    void bench(const char* name, const std::function<void()>& fn)
+    {
+        BenchResult result;
+        result.name   = name;
+        result.pixels = pixels(fn);
+
+        // the fastest repeat is the one least disturbed by the rest of the host
+        uint64_t total  = 0;
+        uint64_t allocs = allocations;
+        uint64_t batch  = 1;
+        result.ns       = 0;
+        for (int repeat = 0; repeat < BENCH_REPEATS; ++repeat)
+        {
+            uint64_t iterations = 0;
+            uint64_t elapsed    = 0;
+            while (elapsed < BENCH_MIN_NS)
+            {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for (uint64_t i = 0; i < batch; ++i)
+                {
+                    fn();
+                }
+                elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                iterations += batch;
+                if (repeat == 0)
+                {
+                    batch *= 2;
+                }
+            }
+            double ns = (double)elapsed / iterations;
+            if (repeat == 0 || ns < result.ns)
+            {
+                result.ns = ns;
+            }
+            total += iterations;
+        }
+        result.allocs = (double)(allocations - allocs) / total;
+        _results.push_back(result);
+        dlog.debug("RenderBench", "%s: %.1f ns %u pixels", name, result.ns, result.pixels);
+    }
+
+    bool load(std::vector<BenchResult>& baseline)
+    {
+        FILE* file = fopen(_path.c_str(), "r");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        char line[160];
+        while (fgets(line, sizeof(line), file))
+        {
+            char        name[64];
+            BenchResult result;
+            if (line[0] != '#' && sscanf(line, "%63s %lf %u %lf", name, &result.ns, &result.pixels, &result.allocs) == 4)
+            {
+                result.name = name;
+                baseline.push_back(result);
+            }
+        }
+        fclose(file);
+        return true;
+    }
+
+    bool record()
+    {
+        FILE* file = fopen(_path.c_str(), "w");
+        if (file == nullptr)
+        {
+            perror(_path.c_str());
+            return false;
+        }
+        fprintf(file, "# name ns/call pixels allocs/call, from bench/RenderBench.cpp \"record\"\n");
+        for (const BenchResult& r : _results)
+        {
+            fprintf(file, "%s %.1f %u %.2f\n", r.name.c_str(), r.ns, r.pixels, r.allocs);
+        }
+        fclose(file);
+        printf("recorded %u benchmarks to %s\n", (unsigned)_results.size(), _path.c_str());
+        return true;
+    }
+
+    void compare()
+    {
+        std::vector<BenchResult> baseline;
+        bool have = load(baseline);
+        printf("%-28s %12s %8s %8s %10s\n", "benchmark", "ns/call", "pixels", "allocs", "vs base");
+        for (const BenchResult& r : _results)
+        {
+            const BenchResult* base = nullptr;
+            for (const BenchResult& b : baseline)
+            {
+                if (b.name == r.name)
+                {
+                    base = &b;
+                }
+            }
+            char change[32] = "";
+            if (base && base->ns > 0)
+            {
+                snprintf(change, sizeof(change), "%+.1f%%", (r.ns - base->ns) * 100.0 / base->ns);
+            }
+            printf("%-28s %12.1f %8u %8.2f %10s%s%s\n", r.name.c_str(), r.ns, r.pixels, r.allocs, change,
+                   base && base->pixels != r.pixels ? " pixels changed" : "",
+                   base && base->allocs != r.allocs ? " allocs changed" : "");
+        }
+        if (!have)
+        {
+            printf("no baseline in %s, \"record\" writes one\n", _path.c_str());
+        }
+    }
+
+    void task()
+    {
+        script();
+        bool ok = true;
+        if (_mode == "record")
+        {
+            ok = record();
+        }
+        else
+        {
+            compare();
+        }
+        fflush(stdout);
+        exit(ok ? 0 : 1);
+    }
+    friend void taskGateway<RenderBench>(void* data);
+};
+
+int main(int argc, char** argv)
+{
+    const char* mode = argc > 1 ? argv[1] : "compare";
+    const char* path = argc > 2 ? argv[2] : "bench/render_baseline.txt";
+    if (strcmp(mode, "compare") != 0 && strcmp(mode, "record") != 0)
+    {
+        fprintf(stderr, "usage: %s [compare|record] [baseline file]\n", argv[0]);
+        return 2;
+    }
+
+    NativeHal::begin(true, 1);
+    dlog.setLevel(getenv("BENCH_VERBOSE") ? DLOG_LEVEL_DEBUG : DLOG_LEVEL_WARNING);
+    static RenderBench bench(App::getInstance(), mode, path);
+    bench.begin();
+    while (true)
+    {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+
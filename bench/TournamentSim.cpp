@@ -0,0 +1,427 @@
+/**
+ * @file TournamentSim.cpp
+ * @author Christoper B. Liebman
+ * @brief host simulator, a day of tournament play on the virtual clock
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ * Build and run on the host:
+ *
+ *   pio run -e native_sim
+ *   .pio/build/native_sim/program [hours] [seed] [trace.txt]
+ *
+ * The real App, Buttons, Display, ScoreJournal and Ticker code runs on the
+ * NativeHal scheduler in virtual time, main.cpp's setup() brings it up as on
+ * the board.  A player task presses the buttons through the GPIO pins
+ * (with contact bounce) for the given hours of play: rallies, the odd swap,
+ * undo and redo, and the next game or match after each game over.
+ *
+ * Everything that happens is written as a trace (time in us and the event)
+ * and hashed.  The same seed gives the same trace and hash, so a scheduling
+ * change either keeps the hash or shows where the run diverged, and a field
+ * bug can be replayed by seed.  The summary has the counts and the virtual
+ * time latencies (deterministic) and the host time per task (not).
+ */
+#include <Arduino.h>
+#include <NativeHal.h>
+#include <SmartMatrix.h>
+#include <dirent.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include "App.h"
+#include "ButtonDebouncer.h"
+#include "Log.h"
+
+// same as main.cpp
+static const uint8_t SCORE_RHS_PIN  = 17;
+static const uint8_t SCORE_LHS_PIN  = 18;
+static const uint8_t SCORE_SWAP_PIN = 19;
+
+static const uint64_t NONE = UINT64_MAX;
+
+static const char* const mode_names[] = { "STARTING", "CHOOSING", "RUNNING", "GAME_OVER" };
+
+// virtual time latencies in us
+struct Latency
+{
+    uint32_t count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+
+    Latency() : count(0), min(NONE), max(0), sum(0) {}
+    void add(uint64_t us)
+    {
+        count++;
+        min  = us < min ? us : min;
+        max  = us > max ? us : max;
+        sum += us;
+    }
+    void print(const char* name) const
+    {
+        if (count == 0)
+        {
+            printf("%-22s none\n", name);
+            return;
+        }
+        printf("%-22s n=%u min=%.3f avg=%.3f max=%.3f ms\n", name, count,
+               min / 1000.0, sum / 1000.0 / count, max / 1000.0);
+    }
+};
+
+class Tournament
+{
+public:
+    Tournament(App& app, double hours, FILE* trace)
+    : _app(app),
+      _end_us((uint64_t)(hours * 3600.0 * 1000000.0)),
+      _trace(trace),
+      _hash(14695981039346656037ULL),
+      _task(nullptr),
+      _released_at(NONE),
+      _changed_at(NONE),
+      _frames(0),
+      _presses(0),
+      _points(0),
+      _games(0),
+      _matches(0),
+      _changes(0)
+    {
+    }
+
+    void begin()
+    {
+        _app.events().subscribe(Delegate<ScoreChanged>::bind<Tournament, &Tournament::changed>(this));
+        _app.events().subscribe(Delegate<ModeChanged>::bind<Tournament, &Tournament::modeChange>(this));
+        _app.events().subscribe(Delegate<GameOver>::bind<Tournament, &Tournament::gameOver>(this));
+        SMLayerBackground::onSwap(std::bind(&Tournament::frame, this));
+        xTaskCreatePinnedToCore(&taskGateway<Tournament>, "Player", 4096, this, 1, &_task, 1);
+    }
+
+private:
+    App&         _app;
+    uint64_t     _end_us;
+    FILE*        _trace;
+    uint64_t     _hash;         // FNV-1a of the trace
+    TaskHandle_t _task;
+    uint64_t     _released_at;  // last short press, for the input latency
+    uint64_t     _changed_at;   // last score change not yet on the panel
+    uint32_t     _frames;
+    uint32_t     _presses;
+    uint32_t     _points;
+    uint32_t     _games;
+    uint32_t     _matches;
+    uint32_t     _changes;
+    Latency      _input;        // button release to ScoreChanged
+    Latency      _display;      // ScoreChanged to the next frame
+
+    void trace(const char* format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char    line[160];
+        int     len = snprintf(line, sizeof(line), "%llu ", (unsigned long long)NativeHal::now());
+        va_list args;
+        va_start(args, format);
+        vsnprintf(line + len, sizeof(line) - len - 1, format, args);
+        va_end(args);
+        strcat(line, "\n");
+        for (const char* p = line; *p; ++p)
+        {
+            _hash = (_hash ^ (uint8_t)*p) * 1099511628211ULL;
+        }
+        if (_trace)
+        {
+            fputs(line, _trace);
+        }
+    }
+
+    uint32_t pick(uint32_t low, uint32_t high)
+    {
+        return low + NativeHal::random() % (high - low + 1);
+    }
+
+    // a few short contacts before the level settles, like a real switch
+    void bounce(uint8_t pin, int level)
+    {
+        for (uint32_t i = pick(0, 3); i > 0; --i)
+        {
+            NativeHal::setPin(pin, level);
+            vTaskDelay(pick(1, 3) / portTICK_PERIOD_MS);
+            NativeHal::setPin(pin, !level);
+            vTaskDelay(pick(1, 3) / portTICK_PERIOD_MS);
+        }
+        NativeHal::setPin(pin, level);
+    }
+
+    void press(uint8_t pin, uint32_t hold_ms)
+    {
+        const char* name = pin == SCORE_LHS_PIN ? "LHS" : pin == SCORE_RHS_PIN ? "RHS" : "SWAP";
+        trace("press %s %u", name, hold_ms);
+        _presses++;
+        _released_at = NONE;    // an earlier press that changed nothing
+        bounce(pin, LOW);
+        vTaskDelay(hold_ms / portTICK_PERIOD_MS);
+        bounce(pin, HIGH);
+        if (hold_ms < BUTTON_LONG_PRESS_MS)
+        {
+            _released_at = NativeHal::now();
+        }
+    }
+
+    void tap(uint8_t pin)
+    {
+        press(pin, pick(80, 250));
+    }
+
+    void hold(uint8_t pin)
+    {
+        press(pin, pick(BUTTON_LONG_PRESS_MS + 100, BUTTON_LONG_PRESS_MS + 800));
+    }
+
+    void waitMode(AppMode mode)
+    {
+        while (_app.mode() != mode)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+
+    void chooseFormat()
+    {
+        switch (pick(0, 4))
+        {
+        case 0: tap(SCORE_LHS_PIN);  break;  // 15
+        case 1: tap(SCORE_RHS_PIN);  break;  // 21
+        case 2: hold(SCORE_LHS_PIN); break;  // table tennis
+        case 3: hold(SCORE_RHS_PIN); break;  // rally 25
+        case 4: tap(SCORE_SWAP_PIN); break;  // 3x15
+        }
+    }
+
+    void task()
+    {
+        waitMode(AppMode::CHOOSING);
+        vTaskDelay(pick(2000, 10000) / portTICK_PERIOD_MS);
+        chooseFormat();
+        waitMode(AppMode::RUNNING);
+
+        // one side is stronger this match
+        uint32_t bias = pick(30, 70);
+        while (NativeHal::now() < _end_us)
+        {
+            vTaskDelay(pick(4000, 25000) / portTICK_PERIOD_MS);
+            if (_app.mode() == AppMode::GAME_OVER)
+            {
+                // players shake hands, the board shows the result, then next game or match
+                vTaskDelay(pick(20000, 120000) / portTICK_PERIOD_MS);
+                bool match_over = _app.match().isMatchOver();
+                hold(SCORE_SWAP_PIN);
+                waitMode(AppMode::RUNNING);
+                if (match_over)
+                {
+                    bias = pick(30, 70);
+                }
+                continue;
+            }
+
+            uint32_t roll = pick(0, 99);
+            if (roll < 2)
+            {
+                // scored the wrong side: undo, then the right one
+                hold(SCORE_LHS_PIN);
+                vTaskDelay(pick(500, 2000) / portTICK_PERIOD_MS);
+                tap(roll ? SCORE_RHS_PIN : SCORE_LHS_PIN);
+            }
+            else if (roll < 3)
+            {
+                // undo by mistake and take it back
+                hold(SCORE_LHS_PIN);
+                vTaskDelay(pick(500, 2000) / portTICK_PERIOD_MS);
+                hold(SCORE_RHS_PIN);
+            }
+            else if (roll < 4)
+            {
+                tap(SCORE_SWAP_PIN);
+            }
+            else
+            {
+                tap(pick(0, 99) < bias ? SCORE_LHS_PIN : SCORE_RHS_PIN);
+            }
+        }
+
+        // let the last change reach the panel and the journal
+        vTaskDelay(2000 / portTICK_PERIOD_MS);
+        report();
+        fflush(stdout);
+        exit(0);
+    }
+    friend void taskGateway<Tournament>(void* data);
+
+    // the rest run on the App task or between tasks
+
+    void changed(const ScoreChanged& event)
+    {
+        const Score::State& s = event.state;
+        const Match::State& m = event.match;
+        trace("score v=%u c=0x%02x red=%d blue=%d swapped=%d game=%d won=%d-%d",
+              event.version, event.changes, s.getTeamScore(Score::RED), s.getTeamScore(Score::BLUE),
+              s.isSwapped(), m.getGame() + 1, m.getGamesWon(Score::RED), m.getGamesWon(Score::BLUE));
+        _changes++;
+        if (event.changes & (CHANGE_LHS_SCORE | CHANGE_RHS_SCORE))
+        {
+            _points++;
+        }
+        if (_released_at != NONE)
+        {
+            _input.add(NativeHal::now() - _released_at);
+            _released_at = NONE;
+        }
+        if (_changed_at == NONE)
+        {
+            _changed_at = NativeHal::now();
+        }
+    }
+
+    void modeChange(const ModeChanged& event)
+    {
+        trace("mode %s", mode_names[event.mode]);
+        if (event.old_mode == AppMode::GAME_OVER && _app.match().getGame() == 0)
+        {
+            _matches++;
+        }
+        xTaskNotifyGive(_task);
+    }
+
+    void gameOver(const GameOver& event)
+    {
+        trace("gameover %s %d-%d", event.winner == Score::RED ? "RED" : "BLUE",
+              event.state.getTeamScore(Score::RED), event.state.getTeamScore(Score::BLUE));
+        _games++;
+    }
+
+    void frame()
+    {
+        _frames++;
+        if (_changed_at != NONE)
+        {
+            _display.add(NativeHal::now() - _changed_at);
+            _changed_at = NONE;
+        }
+    }
+
+    void report()
+    {
+        double seconds = NativeHal::now() / 1000000.0;
+        printf("virtual time:          %.1f s (%.2f h)\n", seconds, seconds / 3600.0);
+        printf("presses:               %u\n", _presses);
+        printf("score changes:         %u (%u points)\n", _changes, _points);
+        printf("games:                 %u\n", _games);
+        printf("matches:               %u\n", _matches);
+        printf("frames:                %u (%.2f fps)\n", _frames, _frames / seconds);
+        printf("context switches:      %u\n", NativeHal::contextSwitches());
+        printf("timers fired:          %u\n", NativeHal::timersFired());
+        _input.print("release to change:");
+        _display.print("change to frame:");
+
+        NativeHal::TaskStats stats[16];
+        size_t count = NativeHal::taskStats(stats, 16);
+        printf("task          runs        host ms\n");
+        uint64_t host_us = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            printf("%-12s %9u %12.1f%s\n", stats[i].name, stats[i].runs, stats[i].host_us / 1000.0,
+                   stats[i].finished ? " (done)" : "");
+            host_us += stats[i].host_us;
+        }
+        printf("host time:             %.2f s (%.0fx real time)\n", host_us / 1000000.0,
+               host_us ? seconds * 1000000.0 / host_us : 0.0);
+        printf("trace hash:            %016llx\n", (unsigned long long)_hash);
+    }
+};
+
+// SPIFFS is flat, the journal is the only thing in it
+static void removeFs(const char* root)
+{
+    DIR* dir = opendir(root);
+    if (dir)
+    {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr)
+        {
+            if (entry->d_name[0] != '.')
+            {
+                std::string path = std::string(root) + "/" + entry->d_name;
+                unlink(path.c_str());
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(root);
+}
+
+static char fs_root[] = "/tmp/tournament-sim-XXXXXX";
+
+static void cleanup()
+{
+    removeFs(fs_root);
+}
+
+int main(int argc, char** argv)
+{
+    double      hours = argc > 1 ? atof(argv[1]) : 10.0;
+    uint32_t    seed  = argc > 2 ? strtoul(argv[2], nullptr, 0) : 1;
+    const char* path  = argc > 3 ? argv[3] : nullptr;
+
+    FILE* trace = nullptr;
+    if (path && (trace = fopen(path, "w")) == nullptr)
+    {
+        perror(path);
+        return 1;
+    }
+    // a fresh file system every run, a journal from an earlier run would resume its game
+    if (mkdtemp(fs_root) == nullptr)
+    {
+        perror(fs_root);
+        return 1;
+    }
+    atexit(cleanup);
+    if (trace)
+    {
+        atexit([] { fflush(nullptr); });
+    }
+
+    printf("tournament: %.2f hours seed %u\n", hours, seed);
+    NativeHal::begin(true, seed);
+    NativeHal::setFsRoot(fs_root);
+    DLog::getLog().setLevel(getenv("SIM_VERBOSE") ? DLOG_LEVEL_DEBUG : DLOG_LEVEL_WARNING);
+
+    static Tournament tournament(App::getInstance(), hours, trace);
+    setup();
+    tournament.begin();
+    while (true)
+    {
+        loop();
+    }
+}
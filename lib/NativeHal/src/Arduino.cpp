@@ -0,0 +1,140 @@
+/**
+ * @file Arduino.cpp
+ * @author Christoper B. Liebman
+ * @brief the Arduino-ESP32 core API the scoreboard uses, for the native HAL
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#include "Arduino.h"
+#include "esp_timer.h"
+
+HardwareSerial Serial;
+EspClass       ESP;
+
+void nativeAttachInterrupt(uint8_t number, void (*isr)(void*), void* arg, int edge);
+
+uint32_t millis()
+{
+    return NativeHal::now() / 1000;
+}
+
+uint32_t micros()
+{
+    return NativeHal::now();
+}
+
+void delay(uint32_t ms)
+{
+    vTaskDelay(ms / portTICK_PERIOD_MS);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    vTaskDelay((us + 999) / 1000);
+}
+
+void yield()
+{
+    taskYIELD();
+}
+
+long random(long howbig)
+{
+    return howbig > 0 ? NativeHal::random() % howbig : 0;
+}
+
+long random(long howsmall, long howbig)
+{
+    return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed)
+{
+    (void)seed;     // the run is seeded by NativeHal::begin()
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void)mode;
+    NativeHal::getPin(pin);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return NativeHal::getPin(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+    NativeHal::setPin(pin, level);
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode)
+{
+    nativeAttachInterrupt(pin, isr, arg, mode);
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    nativeAttachInterrupt(pin, nullptr, nullptr, 0);
+}
+
+void EspClass::restart()
+{
+    fprintf(stderr, "ESP.restart()\n");
+    fflush(stdout);
+    exit(0);
+}
+
+uint32_t esp_random()
+{
+    return NativeHal::random();
+}
+
+esp_reset_reason_t esp_reset_reason()
+{
+    return (esp_reset_reason_t)NativeHal::getResetReason();
+}
+
+int64_t esp_timer_get_time()
+{
+    return NativeHal::now();
+}
+
+// weak so a host program with its own main() does not need a sketch
+void setup() __attribute__((weak));
+void loop() __attribute__((weak));
+
+// the Arduino main, a host program with its own main() replaces it
+__attribute__((weak)) int main(int argc, char** argv)
+{
+    (void)argc;
+    (void)argv;
+    NativeHal::begin(false);
+    setup();
+    while (true)
+    {
+        loop();
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ * @file DLog.cpp
+ * @author Christoper B. Liebman
+ * @brief stdout stand-in for the DLog library
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#include "DLog.h"
+#include <stdio.h>
+
+static const char* const level_names[] = { "", "E", "W", "I", "D", "T" };
+
+void DLogBuffer::vprintf(const char* format, va_list args)
+{
+    if (_len >= sizeof(_buffer) - 1)
+    {
+        return;
+    }
+    int len = vsnprintf(_buffer + _len, sizeof(_buffer) - _len, format, args);
+    if (len > 0)
+    {
+        _len += len;
+        if (_len > sizeof(_buffer) - 1)
+        {
+            _len = sizeof(_buffer) - 1;
+        }
+    }
+}
+
+void DLogBuffer::printf(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+DLog& DLog::getLog()
+{
+    static DLog log;
+    return log;
+}
+
+void DLog::vlog(DLogLevel level, const char* tag, const char* format, va_list args)
+{
+    if (level > _level)
+    {
+        return;
+    }
+    DLogBuffer buffer;
+    if (_pre)
+    {
+        _pre(buffer, level);
+    }
+    buffer.printf("%s %s: ", level_names[level], tag);
+    buffer.vprintf(format, args);
+    buffer.printf("\n");
+    if (_writer)
+    {
+        _writer->write(buffer.c_str());
+    }
+    else
+    {
+        fputs(buffer.c_str(), stdout);
+    }
+}
+
+void DLog::log(DLogLevel level, const char* tag, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vlog(level, tag, format, args);
+    va_end(args);
+}
+
+#define DLOG_LEVEL_METHOD(name, level)                          \
+    void DLog::name(const char* tag, const char* format, ...)   \
+    {                                                           \
+        va_list args;                                           \
+        va_start(args, format);                                 \
+        vlog(level, tag, format, args);                         \
+        va_end(args);                                           \
+    }
+
+DLOG_LEVEL_METHOD(error, DLOG_LEVEL_ERROR)
+DLOG_LEVEL_METHOD(warning, DLOG_LEVEL_WARNING)
+DLOG_LEVEL_METHOD(warn, DLOG_LEVEL_WARNING)
+DLOG_LEVEL_METHOD(info, DLOG_LEVEL_INFO)
+DLOG_LEVEL_METHOD(debug, DLOG_LEVEL_DEBUG)
+DLOG_LEVEL_METHOD(trace, DLOG_LEVEL_TRACE)
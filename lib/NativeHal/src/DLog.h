@@ -0,0 +1,107 @@
+/**
+ * @file DLog.h
+ * @author Christoper B. Liebman
+ * @brief stdout stand-in for the DLog library
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#ifndef NATIVE_DLOG_H_
+#define NATIVE_DLOG_H_
+
+#include <stdarg.h>
+#include "Print.h"
+
+typedef enum
+{
+    DLOG_LEVEL_NONE = 0,
+    DLOG_LEVEL_ERROR,
+    DLOG_LEVEL_WARNING,
+    DLOG_LEVEL_INFO,
+    DLOG_LEVEL_DEBUG,
+    DLOG_LEVEL_TRACE,
+} DLogLevel;
+
+#define DLOG_BUFFER_SIZE 256
+
+class DLogBuffer
+{
+public:
+    DLogBuffer() : _len(0) { _buffer[0] = '\0'; }
+    void        printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void        vprintf(const char* format, va_list args);
+    const char* c_str() const { return _buffer; }
+    size_t      length() const { return _len; }
+
+private:
+    char   _buffer[DLOG_BUFFER_SIZE];
+    size_t _len;
+};
+
+class DLogWriter
+{
+public:
+    virtual ~DLogWriter() {}
+    virtual void write(const char* message) = 0;
+};
+
+typedef void (*DLogPreFunc)(DLogBuffer& buffer, DLogLevel level);
+
+/**
+ * Same interface as the DLog library the target uses, lines are formatted
+ * in one buffer and handed to the writer whole so tasks do not interleave.
+ */
+class DLog
+{
+public:
+    static DLog& getLog();
+
+    void begin(DLogWriter* writer) { _writer = writer; }
+    void setPreFunc(DLogPreFunc func) { _pre = func; }
+    void setLevel(DLogLevel level) { _level = level; }
+
+    void error(const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+    void warning(const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+    void warn(const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+    void info(const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+    void debug(const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+    void trace(const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+    void error(const char* tag, const __FlashStringHelper* message) { log(DLOG_LEVEL_ERROR, tag, "%s", (const char*)message); }
+    void warning(const char* tag, const __FlashStringHelper* message) { log(DLOG_LEVEL_WARNING, tag, "%s", (const char*)message); }
+    void info(const char* tag, const __FlashStringHelper* message) { log(DLOG_LEVEL_INFO, tag, "%s", (const char*)message); }
+    void debug(const char* tag, const __FlashStringHelper* message) { log(DLOG_LEVEL_DEBUG, tag, "%s", (const char*)message); }
+    void trace(const char* tag, const __FlashStringHelper* message) { log(DLOG_LEVEL_TRACE, tag, "%s", (const char*)message); }
+
+private:
+    DLog() : _writer(nullptr), _pre(nullptr), _level(DLOG_LEVEL_INFO) {}
+    void log(DLogLevel level, const char* tag, const char* format, ...);
+    void vlog(DLogLevel level, const char* tag, const char* format, va_list args);
+
+    DLogWriter* _writer;
+    DLogPreFunc _pre;
+    DLogLevel   _level;
+};
+
+#endif // NATIVE_DLOG_H_
@@ -0,0 +1,204 @@
+/**
+ * @file FS.cpp
+ * @author Christoper B. Liebman
+ * @brief Arduino-ESP32 FS and SPIFFS over a host directory, for the native HAL
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#include "FS.h"
+#include "SPIFFS.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace fs;
+
+fs::SPIFFSFS SPIFFS;
+
+File::File(FILE* file, const std::string& name)
+: _file(file, fclose),
+  _name(name)
+{
+}
+
+size_t File::write(uint8_t c)
+{
+    return _file ? fwrite(&c, 1, 1, _file.get()) : 0;
+}
+
+size_t File::write(const uint8_t* data, size_t len)
+{
+    return _file ? fwrite(data, 1, len, _file.get()) : 0;
+}
+
+int File::available()
+{
+    return _file ? (int)(size() - position()) : 0;
+}
+
+int File::read()
+{
+    return _file ? fgetc(_file.get()) : -1;
+}
+
+int File::peek()
+{
+    if (!_file)
+    {
+        return -1;
+    }
+    int c = fgetc(_file.get());
+    if (c != EOF)
+    {
+        ungetc(c, _file.get());
+    }
+    return c;
+}
+
+void File::flush()
+{
+    if (_file)
+    {
+        fflush(_file.get());
+    }
+}
+
+size_t File::read(uint8_t* data, size_t len)
+{
+    return _file ? fread(data, 1, len, _file.get()) : 0;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode)
+{
+    static const int whence[] = { SEEK_SET, SEEK_CUR, SEEK_END };
+    return _file && fseek(_file.get(), pos, whence[mode]) == 0;
+}
+
+size_t File::position() const
+{
+    return _file ? ftell(_file.get()) : 0;
+}
+
+size_t File::size() const
+{
+    if (!_file)
+    {
+        return 0;
+    }
+    fflush(_file.get());
+    struct stat st;
+    return fstat(fileno(_file.get()), &st) == 0 ? st.st_size : 0;
+}
+
+void File::close()
+{
+    _file.reset();
+}
+
+std::string FS::hostPath(const char* path) const
+{
+    std::string host = NativeHal::getFsRoot();
+    if (path[0] != '/')
+    {
+        host += '/';
+    }
+    return host + path;
+}
+
+File FS::open(const char* path, const char* mode)
+{
+    // read and append both need to read back, like SPIFFS
+    const char* host_mode = mode[0] == 'r' ? "rb" : mode[0] == 'a' ? "ab+" : "wb+";
+    FILE* file = fopen(hostPath(path).c_str(), host_mode);
+    if (file == nullptr)
+    {
+        return File();
+    }
+    return File(file, path);
+}
+
+bool FS::exists(const char* path)
+{
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path)
+{
+    return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to)
+{
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool SPIFFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel)
+{
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+    mkdir(NativeHal::getFsRoot(), 0755);
+    struct stat st;
+    return stat(NativeHal::getFsRoot(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool SPIFFSFS::format()
+{
+    DIR* dir = opendir(NativeHal::getFsRoot());
+    if (dir == nullptr)
+    {
+        return false;
+    }
+    while (struct dirent* entry = readdir(dir))
+    {
+        if (entry->d_name[0] != '.')
+        {
+            ::remove(hostPath(entry->d_name).c_str());
+        }
+    }
+    closedir(dir);
+    return true;
+}
+
+size_t SPIFFSFS::usedBytes()
+{
+    size_t used = 0;
+    DIR* dir = opendir(NativeHal::getFsRoot());
+    if (dir == nullptr)
+    {
+        return 0;
+    }
+    while (struct dirent* entry = readdir(dir))
+    {
+        struct stat st;
+        if (entry->d_name[0] != '.' && stat(hostPath(entry->d_name).c_str(), &st) == 0)
+        {
+            used += st.st_size;
+        }
+    }
+    closedir(dir);
+    return used;
+}
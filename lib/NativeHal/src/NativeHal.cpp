@@ -0,0 +1,665 @@
+/**
+ * @file NativeHal.cpp
+ * @author Christoper B. Liebman
+ * @brief cooperative task scheduler, clock, timers and GPIO for the native HAL
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#include "NativeHal.h"
+#include "freertos/FreeRTOS.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NATIVE_FOREVER UINT64_MAX
+
+struct NativeTask
+{
+    std::string             name;
+    TaskFunction_t          fn;
+    void*                   arg;
+    std::condition_variable cv;
+    bool                    blocked;
+    bool                    finished;
+    const void*             waiting_on;     // woken by an event on this, nullptr for a delay
+    uint64_t                wake_at;        // NATIVE_FOREVER for no timeout
+    uint32_t                notify;
+    uint32_t                runs;
+    uint64_t                host_us;
+};
+
+struct NativeQueue
+{
+    size_t                            length;
+    size_t                            item_size;
+    std::deque<std::vector<uint8_t> > items;
+};
+
+struct NativeTimer
+{
+    uint32_t           id;
+    uint64_t           due;
+    uint64_t           period;
+    bool               repeat;
+    NativeHal::Callback fn;
+};
+
+// thrown by vTaskDelete(NULL) to unwind the task's thread
+struct NativeTaskExit {};
+
+static std::mutex                 hal_lock;
+static std::vector<NativeTask*>   hal_tasks;        // creation order, the scheduling order
+static NativeTask*                hal_current   = nullptr;
+static bool                       hal_virtual   = false;
+static uint64_t                   hal_clock     = 0;    // virtual time
+static std::chrono::steady_clock::time_point hal_start;
+static std::vector<NativeTimer>   hal_timers;
+static uint32_t                   hal_timer_id  = 0;
+static int                        hal_isr_depth = 0;
+static uint32_t                   hal_random    = 1;
+static uint32_t                   hal_switches  = 0;
+static uint32_t                   hal_fired     = 0;
+static std::chrono::steady_clock::time_point hal_run_start;    // when hal_current got the CPU
+static int                        hal_reset     = 1;    // ESP_RST_POWERON
+static std::string                hal_fs_root   = ".spiffs";
+static NativeHal::Callback        hal_idle;
+
+struct NativePin
+{
+    int   level;
+    int   mode;
+    void  (*isr)(void*);
+    void* arg;
+    int   edge;
+};
+static std::map<uint8_t, NativePin> hal_pins;
+
+//
+// scheduler
+//
+
+static uint64_t clockNow()
+{
+    if (hal_virtual)
+    {
+        return hal_clock;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hal_start).count();
+}
+
+static void advanceTo(uint64_t when)
+{
+    if (hal_virtual)
+    {
+        if (when > hal_clock)
+        {
+            hal_clock = when;
+        }
+        return;
+    }
+    uint64_t now = clockNow();
+    if (when > now)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(when - now));
+    }
+}
+
+static void fireTimers()
+{
+    uint64_t now = clockNow();
+    // in due order so virtual runs are repeatable, a callback may add or remove timers
+    while (true)
+    {
+        size_t best = hal_timers.size();
+        for (size_t i = 0; i < hal_timers.size(); ++i)
+        {
+            if (hal_timers[i].due <= now && (best == hal_timers.size() || hal_timers[i].due < hal_timers[best].due))
+            {
+                best = i;
+            }
+        }
+        if (best == hal_timers.size())
+        {
+            return;
+        }
+        NativeTimer timer = hal_timers[best];
+        if (timer.repeat)
+        {
+            hal_timers[best].due += timer.period ? timer.period : 1;
+        }
+        else
+        {
+            hal_timers.erase(hal_timers.begin() + best);
+        }
+        hal_fired++;
+        timer.fn();
+    }
+}
+
+static void wakeExpired()
+{
+    uint64_t now = clockNow();
+    for (NativeTask* task : hal_tasks)
+    {
+        if (task->blocked && task->wake_at <= now)
+        {
+            task->blocked = false;
+        }
+    }
+}
+
+static void wakeWaiting(const void* object)
+{
+    for (NativeTask* task : hal_tasks)
+    {
+        if (task->blocked && task->waiting_on == object)
+        {
+            task->blocked = false;
+        }
+    }
+}
+
+// the next task to run after self, moving the clock until there is one
+static NativeTask* pickNext(NativeTask* self)
+{
+    while (true)
+    {
+        fireTimers();
+        wakeExpired();
+
+        size_t count = hal_tasks.size();
+        size_t start = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (hal_tasks[i] == self)
+            {
+                start = i;
+            }
+        }
+        for (size_t i = 1; i <= count; ++i)
+        {
+            NativeTask* task = hal_tasks[(start + i) % count];
+            if (!task->finished && !task->blocked)
+            {
+                return task;
+            }
+        }
+
+        uint64_t next = NATIVE_FOREVER;
+        for (NativeTask* task : hal_tasks)
+        {
+            if (!task->finished && task->wake_at < next)
+            {
+                next = task->wake_at;
+            }
+        }
+        for (const NativeTimer& timer : hal_timers)
+        {
+            if (timer.due < next)
+            {
+                next = timer.due;
+            }
+        }
+        if (next == NATIVE_FOREVER)
+        {
+            if (hal_idle)
+            {
+                hal_idle();
+            }
+            fprintf(stderr, "NativeHal: every task is blocked forever, exiting\n");
+            fflush(stdout);
+            exit(0);
+        }
+        advanceTo(next);
+    }
+}
+
+// hand the CPU to the next task, returns when self is scheduled again
+static void reschedule(bool exiting = false)
+{
+    NativeTask* self = hal_current;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    self->host_us += std::chrono::duration_cast<std::chrono::microseconds>(now - hal_run_start).count();
+    NativeTask* next = pickNext(self);
+    hal_run_start = std::chrono::steady_clock::now();
+    next->runs++;
+    if (next == self && !exiting)
+    {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(hal_lock);
+    hal_switches++;
+    hal_current = next;
+    next->cv.notify_one();
+    if (exiting)
+    {
+        return;
+    }
+    self->cv.wait(lock, [self] { return hal_current == self; });
+}
+
+static uint64_t deadline(TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        return NATIVE_FOREVER;
+    }
+    return clockNow() + (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+// block the running task until an event on object or the deadline
+static void block(const void* object, uint64_t wake_at)
+{
+    NativeTask* self = hal_current;
+    self->blocked    = true;
+    self->waiting_on = object;
+    self->wake_at    = wake_at;
+    reschedule();
+    self->blocked    = false;
+    self->waiting_on = nullptr;
+    self->wake_at    = NATIVE_FOREVER;
+}
+
+static NativeTask* newTask(const char* name, TaskFunction_t fn, void* arg)
+{
+    NativeTask* task = new NativeTask();
+    task->name       = name;
+    task->fn         = fn;
+    task->arg        = arg;
+    task->blocked    = false;
+    task->finished   = false;
+    task->waiting_on = nullptr;
+    task->wake_at    = NATIVE_FOREVER;
+    task->notify     = 0;
+    task->runs       = 0;
+    task->host_us    = 0;
+    hal_tasks.push_back(task);
+    return task;
+}
+
+static void taskThread(NativeTask* task)
+{
+    {
+        std::unique_lock<std::mutex> lock(hal_lock);
+        task->cv.wait(lock, [task] { return hal_current == task; });
+    }
+    try
+    {
+        task->fn(task->arg);
+    }
+    catch (const NativeTaskExit&)
+    {
+    }
+    task->finished = true;
+    reschedule(true);
+}
+
+//
+// NativeHal
+//
+
+void NativeHal::begin(bool virtual_time, uint32_t seed)
+{
+    hal_virtual = virtual_time;
+    hal_clock   = 0;
+    hal_start   = std::chrono::steady_clock::now();
+    hal_run_start = hal_start;
+    hal_random  = seed ? seed : 1;
+    if (hal_current == nullptr)
+    {
+        hal_current = newTask("loopTask", nullptr, nullptr);
+    }
+}
+
+bool NativeHal::isVirtual()
+{
+    return hal_virtual;
+}
+
+uint64_t NativeHal::now()
+{
+    return clockNow();
+}
+
+uint32_t NativeHal::addTimer(uint64_t period_us, bool repeat, Callback fn)
+{
+    NativeTimer timer;
+    timer.id     = ++hal_timer_id;
+    timer.due    = clockNow() + period_us;
+    timer.period = period_us;
+    timer.repeat = repeat;
+    timer.fn     = fn;
+    hal_timers.push_back(timer);
+    return timer.id;
+}
+
+void NativeHal::removeTimer(uint32_t id)
+{
+    for (size_t i = 0; i < hal_timers.size(); ++i)
+    {
+        if (hal_timers[i].id == id)
+        {
+            hal_timers.erase(hal_timers.begin() + i);
+            return;
+        }
+    }
+}
+
+static NativePin& pin(uint8_t number)
+{
+    std::map<uint8_t, NativePin>::iterator it = hal_pins.find(number);
+    if (it == hal_pins.end())
+    {
+        NativePin p = { 1, 0, nullptr, nullptr, 0 };    // pulled up
+        it = hal_pins.insert(std::make_pair(number, p)).first;
+    }
+    return it->second;
+}
+
+void NativeHal::setPin(uint8_t number, int level)
+{
+    NativePin& p = pin(number);
+    level = level ? 1 : 0;
+    if (p.level == level)
+    {
+        return;
+    }
+    p.level = level;
+    // edge: 1 rising, 2 falling, 3 change
+    if (p.isr && (p.edge == 3 || (p.edge == 1 && level) || (p.edge == 2 && !level)))
+    {
+        hal_isr_depth++;
+        p.isr(p.arg);
+        hal_isr_depth--;
+    }
+}
+
+int NativeHal::getPin(uint8_t number)
+{
+    return pin(number).level;
+}
+
+void nativeAttachInterrupt(uint8_t number, void (*isr)(void*), void* arg, int edge)
+{
+    NativePin& p = pin(number);
+    p.isr  = isr;
+    p.arg  = arg;
+    p.edge = edge;
+}
+
+void NativeHal::onIdle(Callback fn)
+{
+    hal_idle = fn;
+}
+
+void NativeHal::setFsRoot(const char* path)
+{
+    hal_fs_root = path;
+}
+
+const char* NativeHal::getFsRoot()
+{
+    return hal_fs_root.c_str();
+}
+
+void NativeHal::setResetReason(int reason)
+{
+    hal_reset = reason;
+}
+
+int NativeHal::getResetReason()
+{
+    return hal_reset;
+}
+
+uint32_t NativeHal::random()
+{
+    // xorshift32, a run is repeatable from its seed
+    uint32_t x = hal_random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return hal_random = x;
+}
+
+uint32_t NativeHal::contextSwitches()
+{
+    return hal_switches;
+}
+
+uint32_t NativeHal::timersFired()
+{
+    return hal_fired;
+}
+
+size_t NativeHal::taskStats(TaskStats* stats, size_t max)
+{
+    size_t count = 0;
+    for (NativeTask* task : hal_tasks)
+    {
+        if (count == max)
+        {
+            break;
+        }
+        stats[count].name     = task->name.c_str();
+        stats[count].runs     = task->runs;
+        stats[count].host_us  = task->host_us;
+        stats[count].finished = task->finished;
+        ++count;
+    }
+    return count;
+}
+
+//
+// FreeRTOS
+//
+
+BaseType_t xPortGetCoreID()
+{
+    return 1;
+}
+
+BaseType_t xPortInIsrContext()
+{
+    return hal_isr_depth > 0;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core)
+{
+    (void)stack;
+    (void)priority;
+    (void)core;
+    NativeTask* task = newTask(name, fn, arg);
+    if (handle)
+    {
+        *handle = task;
+    }
+    std::thread(taskThread, task).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                       UBaseType_t priority, TaskHandle_t* handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, priority, handle, 0);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == nullptr || task == hal_current)
+    {
+        throw NativeTaskExit();
+    }
+    task->finished = true;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    block(nullptr, deadline(ticks));
+}
+
+void taskYIELD()
+{
+    reschedule();
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return clockNow() / 1000 / portTICK_PERIOD_MS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return hal_current;
+}
+
+char* pcTaskGetTaskName(TaskHandle_t task)
+{
+    if (task == nullptr)
+    {
+        task = hal_current;
+    }
+    return task ? (char*)task->name.c_str() : (char*)"none";
+}
+
+UBaseType_t uxTaskGetNumberOfTasks()
+{
+    UBaseType_t count = 0;
+    for (NativeTask* task : hal_tasks)
+    {
+        count += !task->finished;
+    }
+    return count;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+    NativeTask* self    = hal_current;
+    uint64_t    wake_at = deadline(wait);
+    while (self->notify == 0 && wait != 0 && clockNow() < wake_at)
+    {
+        block(self, wake_at);
+    }
+    uint32_t value = self->notify;
+    if (clear)
+    {
+        self->notify = 0;
+    }
+    else if (value)
+    {
+        self->notify--;
+    }
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    task->notify++;
+    wakeWaiting(task);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken)
+{
+    xTaskNotifyGive(task);
+    if (woken)
+    {
+        *woken = pdFALSE;   // nothing is preempted, it runs at the next switch
+    }
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    NativeQueue* queue = new NativeQueue();
+    queue->length      = length;
+    queue->item_size   = item_size;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait)
+{
+    uint64_t wake_at = deadline(wait);
+    while (queue->items.size() >= queue->length)
+    {
+        if (wait == 0 || xPortInIsrContext() || clockNow() >= wake_at)
+        {
+            return pdFALSE;
+        }
+        block(queue, wake_at);
+    }
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.push_back(std::vector<uint8_t>(bytes, bytes + queue->item_size));
+    wakeWaiting(queue);
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t wait)
+{
+    return xQueueSend(queue, item, wait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken)
+{
+    if (woken)
+    {
+        *woken = pdFALSE;
+    }
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait)
+{
+    uint64_t wake_at = deadline(wait);
+    while (queue->items.empty())
+    {
+        if (wait == 0 || clockNow() >= wake_at)
+        {
+            return pdFALSE;
+        }
+        block(queue, wake_at);
+    }
+    memcpy(item, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    wakeWaiting(queue);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->items.size();
+}
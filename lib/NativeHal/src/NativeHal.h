@@ -0,0 +1,87 @@
+/**
+ * @file NativeHal.h
+ * @author Christoper B. Liebman
+ * @brief host side control of the native HAL, clock, tasks, GPIO and storage
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef NATIVE_HAL_H_
+#define NATIVE_HAL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+
+/**
+ * The native env runs src/ as a Linux process on top of this library, a
+ * stand-in for the parts of the Arduino-ESP32 core, FreeRTOS, Ticker,
+ * SmartMatrix and SPIFFS the scoreboard uses.
+ *
+ * Tasks are real threads but only one runs at a time, a task runs until it
+ * blocks (vTaskDelay, ulTaskNotifyTake, a queue) and the next runnable task
+ * in creation order takes over.  Nothing is preempted so a run only depends
+ * on its inputs.  When every task is blocked the clock moves to the next
+ * deadline or timer: by sleeping in real time, or by jumping straight there
+ * in virtual time so hours of play take seconds.
+ */
+class NativeHal
+{
+public:
+    typedef std::function<void()> Callback;
+
+    struct TaskStats
+    {
+        const char* name;
+        uint32_t    runs;       // times it was picked to run, including after its own block
+        uint64_t    host_us;    // real time it held the CPU, varies run to run
+        bool        finished;
+    };
+
+    // call first, from the thread that becomes the "loopTask"
+    static void     begin(bool virtual_time = false, uint32_t seed = 1);
+    static bool     isVirtual();
+    static uint64_t now();          // us since begin()
+
+    // timers fire between tasks, like esp_timer callbacks they must not block
+    static uint32_t addTimer(uint64_t period_us, bool repeat, Callback fn);
+    static void     removeTimer(uint32_t id);
+
+    // drive a GPIO as if from outside, an attached interrupt runs right away
+    static void     setPin(uint8_t pin, int level);
+    static int      getPin(uint8_t pin);
+
+    // called when every task is blocked forever, the default exits
+    static void     onIdle(Callback fn);
+
+    static void     setFsRoot(const char* path);    // host directory behind SPIFFS
+    static const char* getFsRoot();
+    static void     setResetReason(int reason);     // what esp_reset_reason() reports
+    static int      getResetReason();
+    static uint32_t random();                       // esp_random(), seeded by begin()
+    static uint32_t contextSwitches();
+    static uint32_t timersFired();
+    static size_t   taskStats(TaskStats* stats, size_t max);   // creation order
+};
+
+#endif // NATIVE_HAL_H_
@@ -0,0 +1,154 @@
+/**
+ * @file SmartMatrix.cpp
+ * @author Christoper B. Liebman
+ * @brief SmartMatrix layers in memory, for the native HAL
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#include "SmartMatrix.h"
+#include "NativeHal.h"
+#include <algorithm>
+
+int nativeFontWidth(fontChoices font)
+{
+    static const int widths[] = { 3, 5, 6, 8, 6, 6 };
+    return widths[font];
+}
+
+int nativeFontHeight(fontChoices font)
+{
+    static const int heights[] = { 5, 7, 10, 13, 11, 11 };
+    return heights[font];
+}
+
+static std::function<void()> swap_hook;
+
+SMLayerBackground::SMLayerBackground(uint16_t width, uint16_t height)
+: SMLayer(width, height),
+  _front(width * height),
+  _back(width * height),
+  _font(font5x7),
+  _brightness(255),
+  _swaps(0)
+{
+}
+
+void SMLayerBackground::fillScreen(const rgb24& color)
+{
+    std::fill(_back.begin(), _back.end(), color);
+}
+
+void SMLayerBackground::fillRectangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, const rgb24& color)
+{
+    for (int16_t y = y0; y <= y1; ++y)
+    {
+        for (int16_t x = x0; x <= x1; ++x)
+        {
+            drawPixel(x, y, color);
+        }
+    }
+}
+
+void SMLayerBackground::drawPixel(int16_t x, int16_t y, const rgb24& color)
+{
+    if (x >= 0 && y >= 0 && x < _width && y < _height)
+    {
+        _back[y * _width + x] = color;
+    }
+}
+
+void SMLayerBackground::drawString(int16_t x, int16_t y, const rgb24& color, const char* text)
+{
+    (void)x;
+    (void)y;
+    (void)color;
+    (void)text;
+}
+
+void SMLayerBackground::swapBuffers(bool copy)
+{
+    _front.swap(_back);
+    if (copy)
+    {
+        _back = _front;
+    }
+    _swaps++;
+    if (swap_hook)
+    {
+        swap_hook();
+    }
+}
+
+void SMLayerBackground::onSwap(std::function<void()> fn)
+{
+    swap_hook = fn;
+}
+
+SMLayerScrolling::SMLayerScrolling(uint16_t width, uint16_t height)
+: SMLayer(width, height),
+  _text(),
+  _color(255, 255, 255),
+  _mode(wrapForward),
+  _speed(40),
+  _font(font5x7),
+  _top(0),
+  _left(width),
+  _scrolls(0),
+  _started(0)
+{
+}
+
+void SMLayerScrolling::start(const char* text, int scrolls)
+{
+    _text    = text;
+    _scrolls = scrolls;
+    _started = NativeHal::now();
+}
+
+int SMLayerScrolling::textWidth() const
+{
+    return _text.length() * nativeFontWidth(_font);
+}
+
+uint64_t SMLayerScrolling::scrollTime() const
+{
+    uint32_t pixels = _left + textWidth();
+    return (uint64_t)pixels * 1000000 / (_speed ? _speed : 1);
+}
+
+int SMLayerScrolling::getStatus() const
+{
+    if (_scrolls <= 0)
+    {
+        return _scrolls;
+    }
+    uint64_t done = (NativeHal::now() - _started) / scrollTime();
+    return done >= (uint64_t)_scrolls ? 0 : _scrolls - (int)done;
+}
+
+int SMLayerScrolling::getOffsetFromLeft() const
+{
+    uint64_t into = (NativeHal::now() - _started) % scrollTime();
+    return _left - (int)(into * (_speed ? _speed : 1) / 1000000);
+}
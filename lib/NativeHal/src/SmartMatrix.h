@@ -0,0 +1,180 @@
+/**
+ * @file SmartMatrix.h
+ * @author Christoper B. Liebman
+ * @brief SmartMatrix layers in memory, for the native HAL
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef NATIVE_SMARTMATRIX_H_
+#define NATIVE_SMARTMATRIX_H_
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include <string>
+
+struct rgb24
+{
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+
+    rgb24() : red(0), green(0), blue(0) {}
+    rgb24(uint8_t r, uint8_t g, uint8_t b) : red(r), green(g), blue(b) {}
+    bool operator==(const rgb24& other) const { return red == other.red && green == other.green && blue == other.blue; }
+    bool operator!=(const rgb24& other) const { return !(*this == other); }
+};
+
+enum fontChoices
+{
+    font3x5,
+    font5x7,
+    font6x10,
+    font8x13,
+    gohufont11,
+    gohufont11b,
+};
+
+enum ScrollMode
+{
+    wrapForward,
+    bounceForward,
+    bounceReverse,
+    stopped,
+    off,
+    wrapForwardFromLeft,
+};
+
+#define SMARTMATRIX_HUB75_32ROW_MOD16SCAN   0
+#define SMARTMATRIX_OPTIONS_NONE            0
+#define SM_BACKGROUND_OPTIONS_NONE          0
+#define SM_SCROLLING_OPTIONS_NONE           0
+
+class SMLayer
+{
+public:
+    SMLayer(uint16_t width, uint16_t height) : _width(width), _height(height) {}
+    virtual ~SMLayer() {}
+    uint16_t getWidth() const { return _width; }
+    uint16_t getHeight() const { return _height; }
+
+protected:
+    uint16_t _width;
+    uint16_t _height;
+};
+
+/**
+ * Double buffered like the real layer: drawing goes to the back buffer and
+ * swapBuffers(true) makes it the front and copies it back so the back
+ * buffer keeps its content.  Text is accepted but no glyphs are drawn, the
+ * SmartMatrix bitmap fonts are not part of the HAL.
+ */
+class SMLayerBackground : public SMLayer
+{
+public:
+    SMLayerBackground(uint16_t width, uint16_t height);
+    void         fillScreen(const rgb24& color);
+    void         fillRectangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, const rgb24& color);
+    void         drawPixel(int16_t x, int16_t y, const rgb24& color);
+    void         setFont(fontChoices font) { _font = font; }
+    void         drawString(int16_t x, int16_t y, const rgb24& color, const char* text);
+    void         swapBuffers(bool copy = true);
+    void         setBrightness(uint8_t brightness) { _brightness = brightness; }
+    rgb24*       backBuffer() { return _back.data(); }
+    const rgb24* frontBuffer() const { return _front.data(); }
+    uint32_t     getSwaps() const { return _swaps; }
+
+    // called after any background layer swap, what reaches the panel
+    static void  onSwap(std::function<void()> fn);
+
+private:
+    std::vector<rgb24> _front;
+    std::vector<rgb24> _back;
+    fontChoices        _font;
+    uint8_t            _brightness;
+    uint32_t           _swaps;
+};
+
+// scrolls on the HAL clock so getStatus() counts down like the real layer
+class SMLayerScrolling : public SMLayer
+{
+public:
+    SMLayerScrolling(uint16_t width, uint16_t height);
+    void         setColor(const rgb24& color) { _color = color; }
+    void         setMode(ScrollMode mode) { _mode = mode; }
+    void         setSpeed(unsigned char speed) { _speed = speed; }
+    void         setFont(fontChoices font) { _font = font; }
+    void         setOffsetFromTop(int offset) { _top = offset; }
+    void         setStartOffsetFromLeft(int offset) { _left = offset; }
+    void         start(const char* text, int scrolls);
+    void         stop() { _scrolls = 0; }
+    int          getStatus() const;         // scrolls left, -1 for forever, 0 when done
+    const char*  getText() const { return _text.c_str(); }
+    const rgb24& getColor() const { return _color; }
+    fontChoices  getFont() const { return _font; }
+    int          getOffsetFromTop() const { return _top; }
+    int          getOffsetFromLeft() const; // where the text starts now
+
+private:
+    std::string _text;
+    rgb24       _color;
+    ScrollMode  _mode;
+    uint8_t     _speed;     // pixels per second
+    fontChoices _font;
+    int         _top;
+    int         _left;
+    int         _scrolls;
+    uint64_t    _started;   // HAL clock, us
+
+    int      textWidth() const;
+    uint64_t scrollTime() const;    // us for one pass across the panel
+};
+
+class SmartMatrixHub75
+{
+public:
+    SmartMatrixHub75(uint16_t width, uint16_t height) : _width(width), _height(height) {}
+    void     addLayer(SMLayer* layer) { _layers.push_back(layer); }
+    void     begin() {}
+    void     setBrightness(uint8_t brightness) { (void)brightness; }
+    uint16_t getRefreshRate() { return 120; }
+    const std::vector<SMLayer*>& getLayers() const { return _layers; }
+
+private:
+    uint16_t              _width;
+    uint16_t              _height;
+    std::vector<SMLayer*> _layers;
+};
+
+int nativeFontWidth(fontChoices font);
+int nativeFontHeight(fontChoices font);
+
+#define SMARTMATRIX_ALLOCATE_BUFFERS(name, width, height, depth, rows, panel, options) \
+    static SmartMatrixHub75 name(width, height)
+#define SMARTMATRIX_ALLOCATE_BACKGROUND_LAYER(name, width, height, depth, options) \
+    static SMLayerBackground name(width, height)
+#define SMARTMATRIX_ALLOCATE_SCROLLING_LAYER(name, width, height, depth, options) \
+    static SMLayerScrolling name(width, height)
+
+#endif // NATIVE_SMARTMATRIX_H_
@@ -0,0 +1,85 @@
+/**
+ * @file Ticker.h
+ * @author Christoper B. Liebman
+ * @brief Ticker on the native HAL timers
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef NATIVE_TICKER_H_
+#define NATIVE_TICKER_H_
+
+#include <stdint.h>
+#include "NativeHal.h"
+
+class Ticker
+{
+public:
+    typedef void (*callback_t)(void);
+
+    Ticker() : _timer(0) {}
+    ~Ticker() { detach(); }
+
+    void attach(float seconds, callback_t callback) { arm(seconds * 1000000, true, callback); }
+    void attach_ms(uint32_t ms, callback_t callback) { arm((uint64_t)ms * 1000, true, callback); }
+    void once(float seconds, callback_t callback) { arm(seconds * 1000000, false, callback); }
+    void once_ms(uint32_t ms, callback_t callback) { arm((uint64_t)ms * 1000, false, callback); }
+
+    template<typename TArg>
+    void attach(float seconds, void (*callback)(TArg), TArg arg) { arm(seconds * 1000000, true, [callback, arg] { callback(arg); }); }
+    template<typename TArg>
+    void attach_ms(uint32_t ms, void (*callback)(TArg), TArg arg) { arm((uint64_t)ms * 1000, true, [callback, arg] { callback(arg); }); }
+    template<typename TArg>
+    void once(float seconds, void (*callback)(TArg), TArg arg) { arm(seconds * 1000000, false, [callback, arg] { callback(arg); }); }
+    template<typename TArg>
+    void once_ms(uint32_t ms, void (*callback)(TArg), TArg arg) { arm((uint64_t)ms * 1000, false, [callback, arg] { callback(arg); }); }
+
+    void detach()
+    {
+        if (_timer)
+        {
+            NativeHal::removeTimer(_timer);
+            _timer = 0;
+        }
+    }
+
+    bool active() { return _timer != 0; }
+
+private:
+    uint32_t _timer;
+
+    void arm(uint64_t period_us, bool repeat, NativeHal::Callback fn)
+    {
+        detach();
+        if (repeat)
+        {
+            _timer = NativeHal::addTimer(period_us, true, fn);
+            return;
+        }
+        // a one shot forgets its id when it fires so detach() does not remove a stranger
+        uint32_t* timer = &_timer;
+        _timer = NativeHal::addTimer(period_us, false, [timer, fn] { *timer = 0; fn(); });
+    }
+};
+
+#endif // NATIVE_TICKER_H_
@@ -0,0 +1,53 @@
+/**
+ * @file task.h
+ * @author Christoper B. Liebman
+ * @brief FreeRTOS tasks and task notifications for the native HAL
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef NATIVE_FREERTOS_TASK_H_
+#define NATIVE_FREERTOS_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+struct NativeTask;
+typedef NativeTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t  xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                    UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+BaseType_t  xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                        UBaseType_t priority, TaskHandle_t* handle);
+void        vTaskDelete(TaskHandle_t task);
+void        vTaskDelay(TickType_t ticks);
+void        taskYIELD();
+TickType_t  xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+char*       pcTaskGetTaskName(TaskHandle_t task);
+UBaseType_t uxTaskGetNumberOfTasks();
+uint32_t    ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+BaseType_t  xTaskNotifyGive(TaskHandle_t task);
+void        vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+
+#endif // NATIVE_FREERTOS_TASK_H_
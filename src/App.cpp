@@ -33,96 +33,363 @@
 
 static const char* TAG = "App";
 
-AppMode App::mode()
+#if CONFIG_FREERTOS_UNICORE
+#define ARDUINO_RUNNING_CORE 0
+#else
+#define ARDUINO_RUNNING_CORE 1
+#endif
+
+bool App::begin()
 {
-    return _mode;
+    dlog.info(TAG, "Creating App task...");
+    xTaskCreatePinnedToCore(&taskGateway<App>, "App", 8192, this, 1, &_task, ARDUINO_RUNNING_CORE);
+    return true;
 }
 
-AppMode App::mode(AppMode mode)
+void App::task()
 {
-    AppMode old_mode = _mode;
-    for(ModeChangeCB cb : _mode_cb)
+    AppCommand cmd;
+    while (true)
     {
-        cb(mode);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (_commands.pop(cmd))
+        {
+            apply(cmd);
+        }
     }
-    _mode = mode;
-    changeNotify();
-    return old_mode;
 }
 
-void App::changeNotify()
+bool App::post(const AppCommand& cmd)
 {
-    dlog.info(TAG, "changeNotify() size: %d", _change_cb.size());
-    for(ChangeCB cb : _change_cb)
+    if (!_commands.push(cmd))
+    {
+        dlog.error(TAG, "post: command queue full, dropping command %d", cmd.type);
+        return false;
+    }
+    if (_task != nullptr)
     {
-        dlog.info(TAG, "changeNotify() on client!");
-        cb();
+        xTaskNotifyGive(_task);
     }
+    return true;
 }
 
-void App::onChange(ChangeCB cb)
+static uint32_t scoreChanges(const Score::State& before, const Score::State& after)
 {
-    _change_cb.push_back(cb);
+    uint32_t changes = 0;
+    if (before.getScore(Score::LHS) != after.getScore(Score::LHS))
+    {
+        changes |= CHANGE_LHS_SCORE;
+    }
+    if (before.getScore(Score::RHS) != after.getScore(Score::RHS))
+    {
+        changes |= CHANGE_RHS_SCORE;
+    }
+    if (before.isSwapped() != after.isSwapped())
+    {
+        changes |= CHANGE_SWAP;
+    }
+    if (before.getFormat() != after.getFormat() ||
+        before.getLimit() != after.getLimit() || before.getMaxLimit() != after.getMaxLimit())
+    {
+        changes |= CHANGE_LIMITS;
+    }
+    return changes;
 }
 
-void App::onModeChange(ModeChangeCB cb)
+AppMode App::nextMode(AppMode mode, const Score::State& state)
 {
-    _mode_cb.push_back(cb);
+    switch (mode)
+    {
+    case AppMode::STARTING:
+        if (_splash_done && _started)
+        {
+            if (_resumed)
+            {
+                return state.isGameOver() ? AppMode::GAME_OVER : AppMode::RUNNING;
+            }
+            return AppMode::CHOOSING;
+        }
+        break;
+
+    case AppMode::CHOOSING:
+        break;
+
+    case AppMode::RUNNING:
+        if (state.isGameOver())
+        {
+            return AppMode::GAME_OVER;
+        }
+        break;
+
+    case AppMode::GAME_OVER:
+        if (!state.isGameOver())
+        {
+            return AppMode::RUNNING;
+        }
+        break;
+    }
+    return mode;
 }
 
-Score::Side App::getSide(Score::Team team)
+void App::apply(const AppCommand& cmd)
 {
-    return _score.getSide(team);
+    Score::State before       = _score.snapshot();
+    Match::State match_before = _match.snapshot();
+    AppMode      mode         = _mode;
+    AppMode      next   = mode;
+
+    switch (cmd.type)
+    {
+    case AppCommand::SET_MODE:
+        next = (AppMode)cmd.arg1;
+        break;
+
+    case AppCommand::SET_LIMITS:
+        _score.setLimits(cmd.arg1, cmd.arg2);
+        next = AppMode::RUNNING;
+        break;
+
+    case AppCommand::SET_FORMAT:
+        _score.setFormat((ScoreFormat)cmd.arg1);
+        next = AppMode::RUNNING;
+        break;
+
+    case AppCommand::SWAP:
+        _score.swap();
+        if (before.getTeamScore(Score::RED) == 0 && before.getTeamScore(Score::BLUE) == 0)
+        {
+            // before the first point this picks the ends the game starts with
+            _match.startEnds(_score.snapshot().isSwapped());
+        }
+        break;
+
+    case AppCommand::RESET:
+        if (mode == AppMode::GAME_OVER && match_before.isMatchOver())
+        {
+            _match.reset();
+        }
+        else if (mode == AppMode::GAME_OVER)
+        {
+            _match.nextGame();
+        }
+        else
+        {
+            _match.restartGame();
+        }
+        _score.reset(_match.snapshot().isStartSwapped());
+        break;
+
+    case AppCommand::NEW_MATCH:
+        _match.reset();
+        _score.reset();
+        break;
+
+    case AppCommand::INCREMENT:
+        _score.incrementScore((Score::Side)cmd.arg1, cmd.arg2);
+        if (_match.point(before, _score.snapshot()))
+        {
+            dlog.info(TAG, "apply: changing ends for the deciding game");
+            _score.swap();
+        }
+        break;
+
+    case AppCommand::UNDO:
+    {
+        AppLogEntry entry;
+        if (_log.undo(entry))
+        {
+            dlog.info(TAG, "apply: undo command %d from %u", entry.type, entry.when);
+            restore(entry.before, entry.match_before);
+        }
+        break;
+    }
+
+    case AppCommand::REDO:
+    {
+        AppLogEntry entry;
+        if (_log.redo(entry))
+        {
+            dlog.info(TAG, "apply: redo command %d from %u", entry.type, entry.when);
+            restore(entry.after, entry.match_after);
+        }
+        break;
+    }
+
+    case AppCommand::RESUME:
+        dlog.info(TAG, "apply: resuming saved game");
+        restore(Score::State::fromPacked(cmd.arg1), Match::State::fromPacked(cmd.arg2));
+        _resumed = true;
+        break;
+
+    case AppCommand::SPLASH_DONE:
+        _splash_done = true;
+        break;
+
+    case AppCommand::STARTED:
+        _started = true;
+        break;
+
+    case AppCommand::RESTART:
+        dlog.warning(TAG, "restarting!");
+        ESP.restart();
+        break;
+    }
+
+    // the mode follows from the command so it is part of the same notification
+    Score::State after       = _score.snapshot();
+    Match::State match_after = _match.snapshot();
+    if (cmd.type != AppCommand::UNDO && cmd.type != AppCommand::REDO && cmd.type != AppCommand::RESUME &&
+        (after != before || match_after != match_before))
+    {
+        _log.record({millis(), (uint8_t)cmd.type, before, after, match_before, match_after});
+    }
+    doMode(nextMode(next, after));
+
+    uint32_t changes = scoreChanges(before, after);
+    if (_mode != mode)
+    {
+        changes |= CHANGE_MODE;
+    }
+    if (match_after != match_before)
+    {
+        changes |= CHANGE_MATCH;
+    }
+    if (changes != 0)
+    {
+        _version = _version + 1;
+        changeNotify(changes);
+    }
 }
 
-Score::Team App::getTeam(Score::Side side)
+void App::restore(const Score::State& state, const Match::State& match)
 {
-    return _score.getTeam(side);
+    _score.restore(state);
+    _match.restore(match);
 }
 
-int App::getScore(Score::Side side)
+AppMode App::mode()
+{
+    return _mode;
+}
+
+void App::mode(AppMode mode)
+{
+    post({AppCommand::SET_MODE, mode, 0});
+}
+
+void App::doMode(AppMode mode)
+{
+    if (mode == _mode)
+    {
+        return;
+    }
+    _events.publish(ModeChanged{_mode, mode});
+    _mode = mode;
+    if (mode == AppMode::GAME_OVER)
+    {
+        Score::State state = _score.snapshot();
+        _events.publish(GameOver{state.getLeader(), state});
+    }
+}
+
+void App::changeNotify(uint32_t changes)
+{
+    dlog.info(TAG, "changeNotify() version: %u changes: 0x%02x", _version, changes);
+    _events.publish(ScoreChanged{_version, changes, _score.snapshot(), _match.snapshot(), (uint32_t)micros()});
+}
+
+AppEvents& App::events()
+{
+    return _events;
+}
+
+Score::State App::snapshot()
 {
-    return _score.getScore(side);
+    return _score.snapshot();
 }
 
-Score::Team App::getLeader()
+Match::State App::match()
 {
-    return _score.getLeader();
+    return _match.snapshot();
+}
+
+uint32_t App::version()
+{
+    return _version;
 }
 
 void App::setLimits(int value, int max_value)
 {
-    _score.setLimits(value, max_value);
-    mode(AppMode::RUNNING); // will call changeNotify()
+    post({AppCommand::SET_LIMITS, value, max_value});
+}
+
+void App::setFormat(ScoreFormat format)
+{
+    post({AppCommand::SET_FORMAT, format, 0});
 }
 
 void App::swap()
 {
-    _score.swap();
-    changeNotify();
+    post({AppCommand::SWAP, 0, 0});
 }
 
 void App::reset()
 {
-    _score.reset();
-    changeNotify();
+    post({AppCommand::RESET, 0, 0});
+}
+
+void App::newMatch()
+{
+    post({AppCommand::NEW_MATCH, 0, 0});
+}
+
+void App::undo()
+{
+    post({AppCommand::UNDO, 0, 0});
+}
+
+void App::redo()
+{
+    post({AppCommand::REDO, 0, 0});
+}
+
+void App::resume(const Score::State& state, const Match::State& match)
+{
+    post({AppCommand::RESUME, (int)state.getPacked(), (int)match.getPacked()});
 }
 
 void App::incrementScore(Score::Side side, int delta)
 {
-    _score.incrementScore(side, delta);
-    changeNotify();
+    post({AppCommand::INCREMENT, side, delta});
 }
 
-bool App::isGameOver()
+void App::splashDone()
 {
-    return _score.isGameOver();
+    post({AppCommand::SPLASH_DONE, 0, 0});
+}
+
+void App::started()
+{
+    post({AppCommand::STARTED, 0, 0});
+}
+
+void App::restart()
+{
+    post({AppCommand::RESTART, 0, 0});
 }
 
 App::App()
 : _mode(),
+  _version(0),
+  _splash_done(false),
+  _started(false),
+  _resumed(false),
   _score(),
-  _mode_cb()
+  _match(),
+  _log(),
+  _task(nullptr),
+  _commands(),
+  _events()
 {
 }
 
@@ -131,4 +398,3 @@ App& App::getInstance()
     static App instance;
     return instance;
 }
-
@@ -30,39 +30,170 @@
 #ifndef APP_H_
 #define APP_H_
 
-#include <functional>
-#include <vector>
+#include "Arduino.h"
 #include "Score.h"
+#include "Match.h"
+#include "EventBus.h"
+#include "EventLog.h"
+#include "LockFreeQueue.h"
+#include "TaskGateway.h"
+#include "Log.h"
+
+#ifndef APP_COMMAND_QUEUE_SIZE
+#define APP_COMMAND_QUEUE_SIZE 16
+#endif
+
+#ifndef APP_EVENT_LOG_SIZE
+#define APP_EVENT_LOG_SIZE 64
+#endif
+
+#ifndef APP_EVENT_SUBSCRIBERS
+#define APP_EVENT_SUBSCRIBERS 4
+#endif
 
 using AppMode = enum app_mode {STARTING, CHOOSING, RUNNING, GAME_OVER};
-using ModeChangeCB = std::function<void(AppMode mode)>;
-using ChangeCB = std::function<void(void)>;
+
+// what changed in a notification, subscribers can skip work that does not apply to them
+using AppChange = enum app_change {
+    CHANGE_LHS_SCORE = 1 << 0,
+    CHANGE_RHS_SCORE = 1 << 1,
+    CHANGE_SWAP      = 1 << 2,
+    CHANGE_LIMITS    = 1 << 3,   // limits or format
+    CHANGE_MODE      = 1 << 4,
+    CHANGE_MATCH     = 1 << 5,
+    CHANGE_ALL       = (1 << 6) - 1
+};
+
+// published after every applied change, filter on AppChange bits
+struct ScoreChanged
+{
+    uint32_t     version;
+    uint32_t     changes;
+    Score::State state;
+    Match::State match;
+    uint32_t     at_us;     // micros() when published
+    uint32_t filterMask() const { return changes; }
+};
+
+// published before the new mode takes effect, filter on (1 << mode)
+struct ModeChanged
+{
+    AppMode  old_mode;
+    AppMode  mode;
+    uint32_t filterMask() const { return 1 << mode; }
+};
+
+// published when a game is won, filter on (1 << winner)
+struct GameOver
+{
+    Score::Team  winner;
+    Score::State state;
+    uint32_t filterMask() const { return 1 << winner; }
+};
+
+class AppEvents
+{
+public:
+    // an invalid Subscription means APP_EVENT_SUBSCRIBERS is too small
+    template<class E>
+    Subscription<E> subscribe(Delegate<E> delegate, uint32_t filter = EVENT_FILTER_ALL)
+    {
+        Subscription<E> subscription = channel<E>().subscribe(delegate, filter);
+        if (!subscription.valid())
+        {
+            dlog.error("AppEvents", "subscribe: all %d subscriber slots are taken!", APP_EVENT_SUBSCRIBERS);
+        }
+        return subscription;
+    }
+
+    template<class E>
+    void unsubscribe(Subscription<E> subscription)
+    {
+        channel<E>().unsubscribe(subscription);
+    }
+
+    template<class E>
+    void publish(const E& event)
+    {
+        channel<E>().publish(event);
+    }
+
+private:
+    template<class E>
+    EventChannel<E, APP_EVENT_SUBSCRIBERS>& channel();
+
+    EventChannel<ScoreChanged, APP_EVENT_SUBSCRIBERS> _score_changed;
+    EventChannel<ModeChanged,  APP_EVENT_SUBSCRIBERS> _mode_changed;
+    EventChannel<GameOver,     APP_EVENT_SUBSCRIBERS> _game_over;
+};
+
+template<> inline EventChannel<ScoreChanged, APP_EVENT_SUBSCRIBERS>& AppEvents::channel<ScoreChanged>() { return _score_changed; }
+template<> inline EventChannel<ModeChanged,  APP_EVENT_SUBSCRIBERS>& AppEvents::channel<ModeChanged>()  { return _mode_changed; }
+template<> inline EventChannel<GameOver,     APP_EVENT_SUBSCRIBERS>& AppEvents::channel<GameOver>()     { return _game_over; }
 
 class App
 {
 public:
     static App& getInstance();
+    bool begin();
     AppMode mode();
-    AppMode mode(AppMode mode);
-    void onChange(ChangeCB cb);
-    void onModeChange(ModeChangeCB cb);
-    Score::Side getSide(Score::Team team);
-    Score::Team getTeam(Score::Side side);
-    int getScore(Score::Side side);
-    Score::Team getLeader();
+    void mode(AppMode mode);
+    AppEvents& events();
+    Score::State snapshot();
+    Match::State match();
+    uint32_t version();
     void setLimits(int value, int max_value);
+    void setFormat(ScoreFormat format);
     void swap();
     void reset();
+    void newMatch();
+    void undo();
+    void redo();
+    void resume(const Score::State& state, const Match::State& match);
     void incrementScore(Score::Side side, int delta);
-    bool isGameOver();
+    void splashDone();
+    void started();
+    void restart();
 
 private:
+    // every mutation is queued and applied in order by the App task
+    typedef struct app_command {
+        enum {SET_MODE, SET_LIMITS, SET_FORMAT, SWAP, RESET, NEW_MATCH, INCREMENT, UNDO, REDO, RESUME, SPLASH_DONE, STARTED, RESTART} type;
+        int arg1;
+        int arg2;
+    } AppCommand;
+
+    // what an applied command changed, undo restores before and redo restores after
+    typedef struct app_log_entry {
+        uint32_t     when;
+        uint8_t      type;
+        Score::State before;
+        Score::State after;
+        Match::State match_before;
+        Match::State match_after;
+    } AppLogEntry;
+
     App();
-    void changeNotify();
-    AppMode _mode;
+    bool post(const AppCommand& cmd);
+    void apply(const AppCommand& cmd);
+    void restore(const Score::State& state, const Match::State& match);
+    AppMode nextMode(AppMode mode, const Score::State& state);
+    void doMode(AppMode mode);
+    void changeNotify(uint32_t changes);
+    void task();
+    friend void taskGateway<App>(void* data);
+
+    volatile AppMode _mode;
+    volatile uint32_t _version;   // bumped for every applied change
+    bool _splash_done;            // display finished the splash scroll
+    bool _started;                // setup() finished
+    bool _resumed;                // game restored from the journal, skip CHOOSING
     Score _score;
-    std::vector<ModeChangeCB> _mode_cb;
-    std::vector<ChangeCB> _change_cb;
+    Match _match;
+    EventLog<AppLogEntry, APP_EVENT_LOG_SIZE> _log;
+    TaskHandle_t _task;
+    MpscQueue<AppCommand, APP_COMMAND_QUEUE_SIZE> _commands;
+    AppEvents _events;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,174 @@
+/**
+ * @file Boot.cpp
+ * @author Christoper B. Liebman
+ * @brief boot phase profiler
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#include "Boot.h"
+#include <inttypes.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include "Log.h"
+
+static const char* TAG = "Boot";
+
+// survives a software reset, not a power cycle
+#define BOOT_MAGIC 0x426f6f74  // "Boot"
+RTC_NOINIT_ATTR static uint32_t rtc_boot_magic;
+RTC_NOINIT_ATTR static uint32_t rtc_boot_count;
+
+static const char* resetReasonName(int reason)
+{
+    switch (reason)
+    {
+    case ESP_RST_POWERON:   return "poweron";
+    case ESP_RST_EXT:       return "external";
+    case ESP_RST_SW:        return "software";
+    case ESP_RST_PANIC:     return "panic";
+    case ESP_RST_INT_WDT:   return "int_wdt";
+    case ESP_RST_TASK_WDT:  return "task_wdt";
+    case ESP_RST_WDT:       return "wdt";
+    case ESP_RST_DEEPSLEEP: return "deepsleep";
+    case ESP_RST_BROWNOUT:  return "brownout";
+    case ESP_RST_SDIO:      return "sdio";
+    default:                return "unknown";
+    }
+}
+
+Boot::Boot()
+: _boot_count(0),
+  _reset_reason(esp_reset_reason()),
+  _count(0),
+  _marks()
+{
+    if (_reset_reason == ESP_RST_POWERON || rtc_boot_magic != BOOT_MAGIC)
+    {
+        rtc_boot_magic = BOOT_MAGIC;
+        rtc_boot_count = 0;
+    }
+    _boot_count = ++rtc_boot_count;
+}
+
+Boot& Boot::getInstance()
+{
+    static Boot instance;
+    return instance;
+}
+
+bool Boot::isWarm() const
+{
+    return _reset_reason != ESP_RST_POWERON && _reset_reason != ESP_RST_BROWNOUT && _boot_count > 1;
+}
+
+void Boot::mark(const char* name)
+{
+    BootMark mark;
+    mark.name      = name;
+    mark.task      = pcTaskGetTaskName(NULL);
+    mark.us        = esp_timer_get_time();
+    mark.free_heap = ESP.getFreeHeap();
+    mark.largest   = ESP.getMaxAllocHeap();
+    mark.tasks     = uxTaskGetNumberOfTasks();
+
+    size_t seq = _count.fetch_add(1, std::memory_order_relaxed);
+    _marks[seq % BOOT_MAX_MARKS] = mark;
+    dlog.info(TAG, "%s: %" PRId64 " us free:%u largest:%u tasks:%u [%s]",
+              name, mark.us, mark.free_heap, mark.largest, mark.tasks, mark.task);
+}
+
+size_t Boot::count() const
+{
+    size_t count = _count.load(std::memory_order_relaxed);
+    return count < BOOT_MAX_MARKS ? count : BOOT_MAX_MARKS;
+}
+
+const Boot::BootMark& Boot::get(size_t index) const
+{
+    size_t total = _count.load(std::memory_order_relaxed);
+    size_t first = total < BOOT_MAX_MARKS ? 0 : total - BOOT_MAX_MARKS;
+    return _marks[(first + index) % BOOT_MAX_MARKS];
+}
+
+void Boot::writeJson(Print& out) const
+{
+    out.printf("{\"build\":\"%s %s\",\"boot\":%u,\"reset\":\"%s\",\"warm\":%s,\"marks\":[",
+               __DATE__, __TIME__, _boot_count, resetReasonName(_reset_reason), isWarm() ? "true" : "false");
+    size_t count = this->count();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const BootMark& mark = get(i);
+        out.printf("%s{\"name\":\"%s\",\"task\":\"%s\",\"us\":%" PRId64 ",\"free\":%u,\"largest\":%u,\"tasks\":%u}",
+                   i ? "," : "", mark.name, mark.task, mark.us, mark.free_heap, mark.largest, mark.tasks);
+    }
+    out.print("]}");
+}
+
+/**
+ * Chrome trace event format: each mark is a complete event lasting from
+ * the previous mark on the same task, plus heap and task count counters.
+ */
+void Boot::writeTrace(Print& out) const
+{
+    static const int MAX_TRACKS = 8;
+    const char* tracks[MAX_TRACKS];
+    int64_t     last[MAX_TRACKS];
+    int         num_tracks = 0;
+
+    out.printf("{\"displayTimeUnit\":\"ms\",\"otherData\":{\"build\":\"%s %s\",\"boot\":%u,\"reset\":\"%s\"},\"traceEvents\":[",
+               __DATE__, __TIME__, _boot_count, resetReasonName(_reset_reason));
+    out.print("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Scoreboard\"}}");
+
+    size_t count = this->count();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const BootMark& mark = get(i);
+        int tid = 0;
+        while (tid < num_tracks && strcmp(tracks[tid], mark.task) != 0)
+        {
+            ++tid;
+        }
+        if (tid == num_tracks)
+        {
+            if (num_tracks == MAX_TRACKS)
+            {
+                continue; // more tasks than tracks, not expected during boot
+            }
+            tracks[tid] = mark.task;
+            last[tid]   = 0;
+            ++num_tracks;
+            out.printf(",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                       tid, mark.task);
+        }
+        out.printf(",{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%" PRId64 ",\"dur\":%" PRId64 "}",
+                   mark.name, tid, last[tid], mark.us - last[tid]);
+        out.printf(",{\"name\":\"heap\",\"ph\":\"C\",\"pid\":1,\"ts\":%" PRId64 ",\"args\":{\"free\":%u,\"largest\":%u}}",
+                   mark.us, mark.free_heap, mark.largest);
+        out.printf(",{\"name\":\"tasks\",\"ph\":\"C\",\"pid\":1,\"ts\":%" PRId64 ",\"args\":{\"tasks\":%u}}",
+                   mark.us, mark.tasks);
+        last[tid] = mark.us;
+    }
+    out.print("]}");
+}
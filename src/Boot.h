@@ -0,0 +1,75 @@
+/**
+ * @file Boot.h
+ * @author Christoper B. Liebman
+ * @brief boot phase profiler
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef BOOT_H_
+#define BOOT_H_
+
+#include <Arduino.h>
+#include <atomic>
+
+#ifndef BOOT_MAX_MARKS
+#define BOOT_MAX_MARKS 32
+#endif
+
+/**
+ * Boot profiler.  Each mark() records the time since reset, the heap and
+ * the task count into a RAM ring (the newest BOOT_MAX_MARKS survive), from
+ * setup() and from the boot tasks running next to it.  The ring is served
+ * as JSON and as a Chrome trace (chrome://tracing, ui.perfetto.dev) so cold
+ * starts, warm restarts and firmware builds can be compared.
+ */
+class Boot
+{
+public:
+    typedef struct boot_mark {
+        const char* name;
+        const char* task;
+        int64_t     us;         // since reset (esp_timer)
+        uint32_t    free_heap;
+        uint32_t    largest;    // largest free block
+        uint16_t    tasks;
+    } BootMark;
+
+    static Boot& getInstance();
+    void   mark(const char* name);
+    size_t count() const;
+    const BootMark& get(size_t index) const;   // 0 is the oldest kept
+    uint32_t bootCount() const { return _boot_count; }
+    bool   isWarm() const;
+    void   writeJson(Print& out) const;
+    void   writeTrace(Print& out) const;
+
+private:
+    Boot();
+    uint32_t            _boot_count;    // boots since power on
+    int                 _reset_reason;
+    std::atomic<size_t> _count;
+    BootMark            _marks[BOOT_MAX_MARKS];
+};
+
+#endif // BOOT_H_
@@ -0,0 +1,118 @@
+/**
+ * @file ButtonDebouncer.cpp
+ * @author Christoper B. Liebman
+ * @brief debounce and press timing for a single button
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#include "ButtonDebouncer.h"
+
+ButtonDebouncer::ButtonDebouncer(uint32_t debounce_ms, uint32_t long_ms, uint32_t hold_ms)
+: _debounce_ms(debounce_ms),
+  _long_ms(long_ms),
+  _hold_ms(hold_ms),
+  _raw(false),
+  _stable(false),
+  _raw_at(0),
+  _pressed_at(0),
+  _long_sent(false),
+  _hold_sent(false)
+{
+}
+
+void ButtonDebouncer::begin(bool pressed, uint32_t now)
+{
+    // a button already down at startup never generates events until released
+    _raw        = pressed;
+    _stable     = pressed;
+    _raw_at     = now;
+    _pressed_at = now;
+    _long_sent  = pressed;
+    _hold_sent  = pressed;
+}
+
+void ButtonDebouncer::edge(bool pressed, uint32_t when)
+{
+    if (pressed != _raw)
+    {
+        _raw    = pressed;
+        _raw_at = when;
+    }
+}
+
+uint8_t ButtonDebouncer::update(uint32_t now)
+{
+    uint8_t events = NONE;
+
+    if (_raw != _stable && (int32_t)(now - _raw_at) >= (int32_t)_debounce_ms)
+    {
+        _stable = _raw;
+        if (_stable)
+        {
+            _pressed_at = _raw_at;
+            _long_sent  = false;
+            _hold_sent  = false;
+        }
+        else if (!_long_sent)
+        {
+            events |= PRESS;
+        }
+    }
+
+    if (_stable)
+    {
+        uint32_t held = now - _pressed_at;
+        if (!_long_sent && held >= _long_ms)
+        {
+            _long_sent = true;
+            events |= LONG_PRESS;
+        }
+        if (!_hold_sent && held >= _hold_ms)
+        {
+            _hold_sent = true;
+            events |= HOLD;
+        }
+    }
+
+    return events;
+}
+
+uint32_t ButtonDebouncer::nextDeadline(uint32_t now) const
+{
+    if (_raw != _stable)
+    {
+        int32_t remaining = (int32_t)(_raw_at + _debounce_ms - now);
+        return remaining <= 0 ? 0 : remaining;
+    }
+
+    if (!_stable || _hold_sent)
+    {
+        return NO_DEADLINE;
+    }
+
+    uint32_t held  = now - _pressed_at;
+    uint32_t until = _long_sent ? _hold_ms : _long_ms;
+    return held >= until ? 0 : until - held;
+}
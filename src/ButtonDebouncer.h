@@ -0,0 +1,76 @@
+/**
+ * @file ButtonDebouncer.h
+ * @author Christoper B. Liebman
+ * @brief debounce and press timing for a single button
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef BUTTON_DEBOUNCER_H_
+#define BUTTON_DEBOUNCER_H_
+
+#include <stdint.h>
+
+#define BUTTON_DEBOUNCE_MS   35
+#define BUTTON_LONG_PRESS_MS 1000
+#define BUTTON_HOLD_MS       10000
+
+/**
+ * Pure state machine fed with edge timestamps (from the GPIO interrupt) and
+ * polled from update() whenever a deadline returned by nextDeadline() expires.
+ * It has no hardware dependencies so it can be driven by recorded traces.
+ */
+class ButtonDebouncer
+{
+public:
+    enum Event
+    {
+        NONE       = 0,
+        PRESS      = 1 << 0,   // released before the long press time
+        LONG_PRESS = 1 << 1,   // still held at BUTTON_LONG_PRESS_MS
+        HOLD       = 1 << 2,   // still held at BUTTON_HOLD_MS
+    };
+    static const uint32_t NO_DEADLINE = UINT32_MAX;
+
+    ButtonDebouncer(uint32_t debounce_ms = BUTTON_DEBOUNCE_MS,
+                    uint32_t long_ms = BUTTON_LONG_PRESS_MS,
+                    uint32_t hold_ms = BUTTON_HOLD_MS);
+    void     begin(bool pressed, uint32_t now);
+    void     edge(bool pressed, uint32_t when);
+    uint8_t  update(uint32_t now);
+    uint32_t nextDeadline(uint32_t now) const;
+    bool     isPressed() const { return _stable; }
+
+private:
+    uint32_t _debounce_ms;
+    uint32_t _long_ms;
+    uint32_t _hold_ms;
+    bool     _raw;          // last level seen by the interrupt
+    bool     _stable;       // debounced level
+    uint32_t _raw_at;       // time of last raw edge
+    uint32_t _pressed_at;   // time the stable press started
+    bool     _long_sent;
+    bool     _hold_sent;
+};
+
+#endif // BUTTON_DEBOUNCER_H_
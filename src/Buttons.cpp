@@ -28,6 +28,9 @@
 */
 
 #include "Buttons.h"
+#ifdef RENDER_STATS_BUTTON
+#include "RenderStats.h"
+#endif
 #include "Log.h"
 
 #if CONFIG_FREERTOS_UNICORE
@@ -40,72 +43,175 @@ static const char* TAG = "Buttons";
 
 Buttons::Buttons(App& app, int lhs_pin, int rhs_pin, int swap_pin)
 : _app(app),
-  _lhs(lhs_pin), _rhs(rhs_pin), _swap(swap_pin),
-  _lhs_pin(lhs_pin), _rhs_pin(rhs_pin), _swap_pin(swap_pin)
+  _task(nullptr),
+  _mode(AppMode::STARTING),
+  _bound(AppMode::STARTING),
+  _pins{{this, LHS, (uint8_t)lhs_pin}, {this, RHS, (uint8_t)rhs_pin}, {this, SWAP, (uint8_t)swap_pin}},
+  _debouncers(),
+  _on_press(),
+  _on_long_press(),
+  _edges()
 {
 }
 
 bool Buttons::begin()
 {
     dlog.info(TAG, "Creating Buttons task... ");
-    xTaskCreatePinnedToCore(&taskGateway<Buttons>, "Buttons", 8192, this, 1, NULL, ARDUINO_RUNNING_CORE);
+    xTaskCreatePinnedToCore(&taskGateway<Buttons>, "Buttons", 8192, this, 1, &_task, ARDUINO_RUNNING_CORE);
     return true;    
 }
 
+void IRAM_ATTR Buttons::isr(void* arg)
+{
+    ButtonPin* bp = (ButtonPin*)arg;
+    ButtonEdge edge = {bp->button, (uint8_t)(digitalRead(bp->pin) == LOW), millis()};
+    // if the ring is full the edge is dropped, the next edge carries the level anyway
+    bp->buttons->_edges.push(edge);
+    if (bp->buttons->_task == nullptr)
+    {
+        return; // picked up when the task starts
+    }
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(bp->buttons->_task, &woken);
+    if (woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
 void Buttons::task()
 {
     dlog.info(TAG, "task()");
-    pinMode(_swap_pin, INPUT_PULLUP);
-    pinMode(_lhs_pin,  INPUT_PULLUP);
-    pinMode(_rhs_pin,  INPUT_PULLUP);
-    _app.onModeChange(std::bind(&Buttons::modeChange, this, std::placeholders::_1));
+    uint32_t now = millis();
+    for (int i = 0; i < NUM_BUTTONS; ++i)
+    {
+        pinMode(_pins[i].pin, INPUT_PULLUP);
+        _debouncers[i].begin(digitalRead(_pins[i].pin) == LOW, now);
+        attachInterruptArg(_pins[i].pin, &Buttons::isr, &_pins[i], CHANGE);
+    }
+    _app.events().subscribe(Delegate<ModeChanged>::bind<Buttons, &Buttons::modeChange>(this));
+    // the mode may have changed before _task was set, nothing woke us for it
+    bind(_mode.load());
+
+    TickType_t wait = portMAX_DELAY;
     while(true)
     {
-        _swap.read();
-        _lhs.read();
-        _rhs.read();
+        // sleep until an edge arrives or the next debounce/press deadline
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        // the callbacks are only ever touched here, never under dispatch()
+        AppMode mode = _mode.load();
+        if (mode != _bound)
+        {
+            bind(mode);
+        }
+
+        ButtonEdge edge;
+        while (_edges.pop(edge))
+        {
+            _debouncers[edge.button].edge(edge.pressed, edge.when);
+        }
+        now = millis();
+
+        uint32_t next = ButtonDebouncer::NO_DEADLINE;
+        for (int i = 0; i < NUM_BUTTONS; ++i)
+        {
+            uint8_t events = _debouncers[i].update(now);
+            if (events != ButtonDebouncer::NONE)
+            {
+                dispatch((Button)i, events);
+            }
+            uint32_t deadline = _debouncers[i].nextDeadline(now);
+            if (deadline < next)
+            {
+                next = deadline;
+            }
+        }
+
+        if (next == ButtonDebouncer::NO_DEADLINE)
+        {
+            wait = portMAX_DELAY;
+        }
+        else
+        {
+            wait = next / portTICK_PERIOD_MS + 1;
+        }
     }
-    delay(1);
 }
 
-bool Buttons::isReset()
+void Buttons::dispatch(Button button, uint8_t events)
 {
-    return _swap.pressedFor(10000);
+    dlog.debug(TAG, "dispatch: button: %d events: 0x%02x", button, events);
+    if (events & ButtonDebouncer::PRESS && _on_press[button])
+    {
+        _on_press[button]();
+    }
+    if (events & ButtonDebouncer::LONG_PRESS && _on_long_press[button])
+    {
+        _on_long_press[button]();
+    }
+    // soft reset: hold swap for 10ish seconds
+    if (events & ButtonDebouncer::HOLD && button == SWAP)
+    {
+        _app.restart();
+    }
 }
 
-void Buttons::modeChange(AppMode mode)
+/**
+ * Runs on the App task, so only the mode is handed over and the Buttons
+ * task rebinds the callbacks itself before it dispatches the next event.
+ */
+void Buttons::modeChange(const ModeChanged& event)
 {
     dlog.info(TAG, "modeChange()");
+    _mode = event.mode;
+    if (_task == nullptr)
+    {
+        return; // picked up when the task starts
+    }
+    xTaskNotifyGive(_task);
+}
+
+void Buttons::bind(AppMode mode)
+{
+    _bound = mode;
     switch (mode)
     {
     case AppMode::STARTING:
-        dlog.info(TAG, "modeChange: STARTING");
-        _swap.onPressed(nullptr);
-        _swap.onPressedFor(1000, nullptr);
-        _lhs.onPressed(nullptr);
-        _lhs.onPressedFor(1000, nullptr);
-        _rhs.onPressed(nullptr);
-        _rhs.onPressedFor(1000, nullptr);
+        dlog.info(TAG, "bind: STARTING");
+        for (int i = 0; i < NUM_BUTTONS; ++i)
+        {
+            _on_press[i]      = nullptr;
+            _on_long_press[i] = nullptr;
+        }
         break;
 
     case AppMode::CHOOSING:
-        dlog.info(TAG, "modeChange: CHOOSING");
-        _lhs.onPressed(std::bind(&App::setLimits, &_app, 15, 20));
-        _rhs.onPressed(std::bind(&App::setLimits, &_app, 21, 30));
+        dlog.info(TAG, "bind: CHOOSING");
+        // 15 and 21 are on the panel, the scroll names the rest
+        _on_press[LHS]      = std::bind(&App::setFormat, &_app, FORMAT_BADMINTON_15);
+        _on_press[RHS]      = std::bind(&App::setFormat, &_app, FORMAT_BADMINTON_21);
+        _on_long_press[LHS] = std::bind(&App::setFormat, &_app, FORMAT_TABLE_TENNIS);
+        _on_long_press[RHS] = std::bind(&App::setFormat, &_app, FORMAT_RALLY_25);
+        _on_press[SWAP]     = std::bind(&App::setFormat, &_app, FORMAT_BADMINTON_3X15);
+#ifdef RENDER_STATS_BUTTON
+        // render telemetry on the panel for bench work, see RenderStats
+        _on_long_press[SWAP] = std::bind(&RenderStats::toggleOverlay, &RenderStats::getInstance());
+#else
+        _on_long_press[SWAP] = nullptr;
+#endif
         break;
 
     case AppMode::RUNNING:
-        dlog.info(TAG, "modeChange: RUNNING");
-        _swap.onPressed(std::bind(&App::swap, &_app));
-        _swap.onPressedFor(1000, std::bind(&App::reset, &_app));
-        _lhs.onPressed(std::bind(&App::incrementScore, &_app, Score::LHS, 1));
-        _lhs.onPressedFor(1000, std::bind(&App::incrementScore, &_app, Score::LHS, -1));
-        _rhs.onPressed(std::bind(&App::incrementScore, &_app, Score::RHS, 1));
-        _rhs.onPressedFor(1000, std::bind(&App::incrementScore, &_app, Score::RHS, -1));
-        break;
-
     case AppMode::GAME_OVER:
-        dlog.info(TAG, "modeChange: GAME_OVER");
+        // GAME_OVER can be entered directly when a saved game is resumed
+        dlog.info(TAG, "bind: %s", mode == AppMode::RUNNING ? "RUNNING" : "GAME_OVER");
+        _on_press[SWAP]      = std::bind(&App::swap, &_app);
+        _on_long_press[SWAP] = std::bind(&App::reset, &_app);
+        _on_press[LHS]       = std::bind(&App::incrementScore, &_app, Score::LHS, 1);
+        _on_long_press[LHS]  = std::bind(&App::undo, &_app);
+        _on_press[RHS]       = std::bind(&App::incrementScore, &_app, Score::RHS, 1);
+        _on_long_press[RHS]  = std::bind(&App::redo, &_app);
         break;
     }
 }
@@ -31,28 +31,51 @@
 #define BUTTONS_H_
 
 #include <Arduino.h>
+#include <atomic>
 #include <functional>
-#include <EasyButton.h>
 #include "App.h"
+#include "ButtonDebouncer.h"
+#include "LockFreeQueue.h"
 #include "TaskGateway.h"
 
+using ButtonCB = std::function<void(void)>;
+
 class Buttons
 {
 public:
+    enum Button {LHS = 0, RHS = 1, SWAP = 2, NUM_BUTTONS};
     Buttons(App& app, int lhs_pin, int rhs_pin, int swap_pin);
     bool begin();
-    bool isReset();
-    void modeChange(AppMode mode);
+    void modeChange(const ModeChanged& event);
 
 private:
-    App&       _app;
-    EasyButton _lhs;
-    EasyButton _rhs;
-    EasyButton _swap;
-    uint8_t    _lhs_pin;
-    uint8_t    _rhs_pin;
-    uint8_t    _swap_pin;
+    typedef struct button_edge {
+        uint8_t  button;
+        uint8_t  pressed;
+        uint32_t when;
+    } ButtonEdge;
+
+    typedef struct button_pin {
+        Buttons* buttons;
+        uint8_t  button;
+        uint8_t  pin;
+    } ButtonPin;
+
+    App&                         _app;
+    TaskHandle_t                 _task;
+    std::atomic<AppMode>         _mode;     // set by modeChange() on the App task
+    AppMode                      _bound;    // mode the callbacks are set for, task only
+    ButtonPin                    _pins[NUM_BUTTONS];
+    ButtonDebouncer              _debouncers[NUM_BUTTONS];
+    ButtonCB                     _on_press[NUM_BUTTONS];
+    ButtonCB                     _on_long_press[NUM_BUTTONS];
+    SpscQueue<ButtonEdge, 32>    _edges;    // filled by the gpio interrupt
+
+    static void IRAM_ATTR isr(void* arg);
+    void bind(AppMode mode);
+    void dispatch(Button button, uint8_t events);
     void task();
-    friend void taskGateway<Buttons>(void*data);};
+    friend void taskGateway<Buttons>(void*data);
+};
 
-#endif
\ No newline at end of file
+#endif
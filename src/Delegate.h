@@ -0,0 +1,90 @@
+/**
+ * @file Delegate.h
+ * @author Christoper B. Liebman
+ * @brief non-allocating callable bound to a function or object method
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef DELEGATE_H_
+#define DELEGATE_H_
+
+/**
+ * A delegate is just an object pointer and a stub function pointer so it can
+ * be copied, stored in fixed arrays and called from any context without ever
+ * touching the heap (unlike std::function + std::bind).
+ *
+ *   Delegate<Event>::bind<Display, &Display::handler>(this)
+ *   Delegate<Event>::bind<&freeFunction>()
+ */
+template<class Arg>
+class Delegate
+{
+public:
+    Delegate() : _object(nullptr), _stub(nullptr) {}
+
+    template<class T, void (T::*METHOD)(const Arg&)>
+    static Delegate bind(T* object)
+    {
+        return Delegate(object, &methodStub<T, METHOD>);
+    }
+
+    template<void (*FUNCTION)(const Arg&)>
+    static Delegate bind()
+    {
+        return Delegate(nullptr, &functionStub<FUNCTION>);
+    }
+
+    void operator()(const Arg& arg) const
+    {
+        _stub(_object, arg);
+    }
+
+    explicit operator bool() const
+    {
+        return _stub != nullptr;
+    }
+
+private:
+    using Stub = void (*)(void* object, const Arg& arg);
+
+    Delegate(void* object, Stub stub) : _object(object), _stub(stub) {}
+
+    template<class T, void (T::*METHOD)(const Arg&)>
+    static void methodStub(void* object, const Arg& arg)
+    {
+        (static_cast<T*>(object)->*METHOD)(arg);
+    }
+
+    template<void (*FUNCTION)(const Arg&)>
+    static void functionStub(void* object, const Arg& arg)
+    {
+        (void)object;
+        FUNCTION(arg);
+    }
+
+    void* _object;
+    Stub  _stub;
+};
+
+#endif // DELEGATE_H_
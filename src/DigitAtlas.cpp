@@ -0,0 +1,121 @@
+/**
+ * @file DigitAtlas.cpp
+ * @author Christoper B. Liebman
+ * @brief pre-rasterized score digits
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#include "DigitAtlas.h"
+#include <string.h>
+
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#endif
+
+DigitAtlas::DigitAtlas()
+: _glyphs(),
+  _advance(0),
+  _top(0),
+  _height(0)
+{
+}
+
+/**
+ * Unpack the font bitmaps for '0'-'9', the font bits run on from row to
+ * row MSB first.  Returns false if the font has no digits or they are too
+ * big for the row masks.
+ */
+bool DigitAtlas::build(const GFXfont* font)
+{
+    if (font->first > '0' || font->last < '9')
+    {
+        return false;
+    }
+    _advance = 0;
+    int top    = 0;
+    int bottom = 0;
+    for (int digit = 0; digit < 10; ++digit)
+    {
+        const GFXglyph& src = font->glyph['0' + digit - font->first];
+        if (src.width > DIGIT_ATLAS_MAX_WIDTH || src.height > DIGIT_ATLAS_MAX_HEIGHT)
+        {
+            return false;
+        }
+        Glyph& glyph = _glyphs[digit];
+        memset(&glyph, 0, sizeof(glyph));
+        glyph.x_offset = src.xOffset;
+        glyph.y_offset = src.yOffset;
+        glyph.height   = src.height;
+        const uint8_t* bitmap = font->bitmap + src.bitmapOffset;
+        uint32_t bit = 0;
+        for (int row = 0; row < src.height; ++row)
+        {
+            for (int col = 0; col < src.width; ++col, ++bit)
+            {
+                if (pgm_read_byte(bitmap + bit / 8) & (0x80 >> (bit % 8)))
+                {
+                    glyph.rows[row] |= 1 << col;
+                }
+            }
+        }
+        if (src.xAdvance > _advance)
+        {
+            _advance = src.xAdvance;
+        }
+        if (digit == 0 || src.yOffset < top)
+        {
+            top = src.yOffset;
+        }
+        if (digit == 0 || src.yOffset + src.height > bottom)
+        {
+            bottom = src.yOffset + src.height;
+        }
+    }
+    _top    = top;
+    _height = bottom - top;
+    return true;
+}
+
+int DigitAtlas::textWidth(const GFXfont* font, const char* text)
+{
+    int x    = 0;
+    int minx = 0x7fff;
+    int maxx = -1;
+    for (; *text; ++text)
+    {
+        uint8_t c = *text;
+        if (c < font->first || c > font->last)
+        {
+            continue;
+        }
+        const GFXglyph& glyph = font->glyph[c - font->first];
+        int x0 = x + glyph.xOffset;
+        int x1 = x0 + glyph.width - 1;
+        minx = x0 < minx ? x0 : minx;
+        maxx = x1 > maxx ? x1 : maxx;
+        x += glyph.xAdvance;
+    }
+    return maxx >= minx ? maxx - minx + 1 : 0;
+}
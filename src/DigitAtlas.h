@@ -0,0 +1,125 @@
+/**
+ * @file DigitAtlas.h
+ * @author Christoper B. Liebman
+ * @brief pre-rasterized score digits
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef DIGIT_ATLAS_H_
+#define DIGIT_ATLAS_H_
+
+#include <stdint.h>
+#include <gfxfont.h>
+
+#define DIGIT_ATLAS_MAX_WIDTH  16
+#define DIGIT_ATLAS_MAX_HEIGHT 32
+
+/**
+ * Digits 0-9 of a GFX font rasterized once into one row mask per glyph row
+ * (bit 0 is the leftmost column) so drawing a digit is a blit of set bits
+ * straight into a row-major pixel buffer instead of a drawPixel() per bit.
+ * No hardware dependencies, the pixel type is a template parameter.
+ */
+class DigitAtlas
+{
+public:
+    DigitAtlas();
+    bool build(const GFXfont* font);
+    int  getAdvance() const { return _advance; }
+    int  getTop() const { return _top; }          // highest glyph row relative to the baseline
+    int  getHeight() const { return _height; }    // rows from getTop() to the lowest glyph row
+
+    // the width Adafruit_GFX::getTextBounds() reports for text in font
+    static int textWidth(const GFXfont* font, const char* text);
+
+    // the cursor is on the baseline like Adafruit_GFX, only pixels inside
+    // the clip rectangle [cx0, cx1) x [cy0, cy1) are written, returns the x advance
+    template<class PIXEL>
+    int blit(PIXEL* buffer, int width, int x, int y, int digit, const PIXEL& color,
+             int cx0, int cy0, int cx1, int cy1) const
+    {
+        const Glyph& glyph = _glyphs[digit];
+        int x0  = x + glyph.x_offset;
+        int top = y + glyph.y_offset;
+        for (int row = 0; row < glyph.height; ++row)
+        {
+            int y0 = top + row;
+            if (y0 < cy0 || y0 >= cy1)
+            {
+                continue;
+            }
+            PIXEL*   line = buffer + y0 * width;
+            uint16_t mask = glyph.rows[row];
+            while (mask)
+            {
+                int col = __builtin_ctz(mask);
+                mask &= mask - 1;
+                int xp = x0 + col;
+                if (xp >= cx0 && xp < cx1)
+                {
+                    line[xp] = color;
+                }
+            }
+        }
+        return _advance;
+    }
+
+    template<class PIXEL>
+    int blit(PIXEL* buffer, int width, int height, int x, int y, int digit, const PIXEL& color) const
+    {
+        return blit(buffer, width, x, y, digit, color, 0, 0, width, height);
+    }
+
+    // both digits of a 00-99 value, a side of the panel only fits two so
+    // anything higher (uncapped formats can reach 127) shows as 99
+    template<class PIXEL>
+    void blit2(PIXEL* buffer, int width, int x, int y, int value, const PIXEL& color,
+               int cx0, int cy0, int cx1, int cy1) const
+    {
+        value = value > 99 ? 99 : value;
+        x += blit(buffer, width, x, y, (value / 10) % 10, color, cx0, cy0, cx1, cy1);
+        blit(buffer, width, x, y, value % 10, color, cx0, cy0, cx1, cy1);
+    }
+
+    template<class PIXEL>
+    void blit2(PIXEL* buffer, int width, int height, int x, int y, int value, const PIXEL& color) const
+    {
+        blit2(buffer, width, x, y, value, color, 0, 0, width, height);
+    }
+
+private:
+    typedef struct glyph {
+        int8_t   x_offset;
+        int8_t   y_offset;
+        uint8_t  height;
+        uint16_t rows[DIGIT_ATLAS_MAX_HEIGHT];
+    } Glyph;
+
+    Glyph _glyphs[10];
+    int   _advance;     // widest digit advance, scores are fixed width
+    int   _top;
+    int   _height;
+};
+
+#endif // DIGIT_ATLAS_H_
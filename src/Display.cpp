@@ -29,12 +29,7 @@
 
 #include "Arduino.h"
 #include "Display.h"
-#include <Adafruit_GFX.h>
-#include <SmartMatrix_GFX.h>
 #include <GFXFonts/br2_serif_score_23.h>
-#include <Fonts/Lekton_Bold_18.h>
-#include <MatrixHardware_ESP32_V0.h>
-#include <SmartMatrix.h>
 #include "Log.h"
 
 #if CONFIG_FREERTOS_UNICORE
@@ -43,59 +38,42 @@
 #define ARDUINO_RUNNING_CORE 1
 #endif
 
-#define CMD_RENDER          ((const char*)0)   // refresh display
-#define CMD_STOP_SCROLL     ((const char*)1)   // stop scrolling
-#define CMD_BLINK           ((const char*)2)   // blink interval
-#define CMD_SCROLL_GAMEOVER ((const char*)3)   // scroll _message once a minute
-
 #define SCORE_FONT (&br2_serif_score_23)
-#define FPS_FONT (font3x5)
-#define STARTING_FONT (font5x7)
+#define FPS_FONT (RENDER_FONT_3X5)
+#define STATS_FONT (RENDER_FONT_3X5)
+#define STATS_LINE_HIGHT (6)
+#define STARTING_FONT (RENDER_FONT_5X7)
 #define STARTING_FONT_WIDTH (5)
 #define STARTING_FONT_HIGHT (7)
-#define SCROLL_FONT (gohufont11b)
+#define SCROLL_FONT (RENDER_FONT_GOHU11B)
 #define SCROLL_FONT_HIGHT (11)
-#define GAME_OVER_FONT (gohufont11b)
+#define GAME_OVER_FONT (RENDER_FONT_GOHU11B)
 #define GAME_OVER_FONT_HIGHT (11)
 
 #define SCORE_COLOR  white
 
-static bool initialized = false;
+#define EFFECT_PERIOD_MS    100     // effects were tuned for one step this often
+#define SPLASH_PERIOD_MS    10      // and the splash twinkle for this often
+#ifndef FRAME_STATS_LOG_MS
+#define FRAME_STATS_LOG_MS  10000
+#endif
+
 static const char* TAG = "Display";
 
-#define COLOR_DEPTH 24                  // known working: 24, 48 - If the sketch uses type `rgb24` directly, COLOR_DEPTH must be 24
-static const uint8_t kMatrixWidth = 64;        // known working: 32, 64, 96, 128
-static const uint8_t kMatrixHeight = 32;       // known working: 16, 32, 48, 64
-static const uint8_t kRefreshDepth = 24;       // known working: 24, 36, 48
-static const uint8_t kDmaBufferRows = 2;       // known working: 2-4, use 2 to save memory, more to keep from dropping frames and automatically lowering refresh rate
-static const uint8_t kPanelType = SMARTMATRIX_HUB75_32ROW_MOD16SCAN;
-static const uint8_t kMatrixOptions = (SMARTMATRIX_OPTIONS_NONE);
-static const uint8_t kBackgroundLayerOptions = (SM_BACKGROUND_OPTIONS_NONE);
-static const uint8_t kScrollingLayerOptions = (SM_SCROLLING_OPTIONS_NONE);
-
-SMARTMATRIX_ALLOCATE_BUFFERS(matrix, kMatrixWidth, kMatrixHeight, kRefreshDepth, kDmaBufferRows, kPanelType, kMatrixOptions);
-SMARTMATRIX_ALLOCATE_BACKGROUND_LAYER(backgroundLayer, kMatrixWidth, kMatrixHeight, COLOR_DEPTH, kBackgroundLayerOptions);
-SMARTMATRIX_ALLOCATE_SCROLLING_LAYER(scrollingLayer, kMatrixWidth, kMatrixHeight, COLOR_DEPTH, kScrollingLayerOptions);
-static CRGB *gfx_buffer;
-static void show_callback();
-static SmartMatrix_GFX *gfx = new SmartMatrix_GFX(gfx_buffer, kMatrixWidth, kMatrixHeight, show_callback);
-// Sadly this callback function must be copied around with this init code
-static void show_callback() {
-    backgroundLayer.swapBuffers(true);
-    gfx_buffer = (CRGB *)backgroundLayer.backBuffer();
-    gfx->newLedsPtr(gfx_buffer);
-}
+// the panel, a RenderTarget is made this size
+static const uint8_t kMatrixWidth = 64;
+static const uint8_t kMatrixHeight = 32;
 
 static const int defaultBrightness = (100*255)/100;    // full (100%) brightness
-static const rgb24 red(255, 0, 0);
-static const rgb24 green(0, 255, 0);
-static const rgb24 blue(0, 0, 255);
-static const rgb24 white(255, 255, 255);
-static const rgb24 black(0, 0, 0);
-static const rgb24 yellow(255, 255, 0);
-static const rgb24 orange(255, 165, 0);
-
-static const rgb24& getTeamColor(const Score::Team team)
+static const CRGB red(255, 0, 0);
+static const CRGB green(0, 255, 0);
+static const CRGB blue(0, 0, 255);
+static const CRGB white(255, 255, 255);
+static const CRGB black(0, 0, 0);
+static const CRGB yellow(255, 255, 0);
+static const CRGB orange(255, 165, 0);
+
+static const CRGB& getTeamColor(const Score::Team team)
 {
     if (team == Score::RED)
     {
@@ -105,54 +83,78 @@ static const rgb24& getTeamColor(const Score::Team team)
 }
 
 
-Display::Display(App& app) : _app(app)
+Display::Display(App& app, RenderTarget& target)
+: _app(app),
+  _target(target),
+  _task(nullptr),
+  _pending(0),
+  _posted(),
+  _overlays(),
+  _overlay_up(false),
+  _blink_state(false),
+  _no_clear(false),
+  _splashing(false),
+  _resumed(false),
+  _rendered_scene(),
+  _rendered_version(0),
+  _gameover_text(),
+  _digits(),
+  _score_width(0),
+  _frames(),
+  _effects(),
+  _engine(),
+  _dirty(true),
+  _stats(RenderStats::getInstance()),
+  _stats_up(false),
+  _changed_at(0),
+  _render_changed_at(0)
 {
-    _queue = xQueueCreate( 4, sizeof( const char* ) );
 }
 
 Display::~Display()
 {
-    vQueueDelete(_queue);
-    _queue = 0;
 }
 
-void Display::begin(const char* message)
+void Display::begin(const char* message, bool show_splash)
 {
-    if (!initialized)
+    _target.begin(defaultBrightness);
+    // measure and rasterize the score font once, the scene only blits
+    _score_width = DigitAtlas::textWidth(SCORE_FONT, "00") + 4;
+    if (!_digits.build(SCORE_FONT))
     {
-        matrix.addLayer(&backgroundLayer);
-        matrix.addLayer(&scrollingLayer);
-        matrix.begin();
-        matrix.setBrightness(defaultBrightness);
-        backgroundLayer.setBrightness(defaultBrightness);
-        // This sets the neomatrix and LEDMatrix pointers
-        show_callback();
-        backgroundLayer.fillScreen( black );
-        backgroundLayer.swapBuffers();
-        gfx->begin();
-        gfx->setTextWrap(false);
-        initialized = true;
+        dlog.error(TAG, "begin: score font does not fit the digit atlas!");
     }
-    splash(message);
-    while (isScrolling())
+    // the display task twinkles while the splash scrolls, a resumed game skips it
+    // and shows its score from the first frame
+    _resumed = !show_splash;
+    if (show_splash)
     {
-        delay(10);
-        uint8_t value = random(255);
-        doTwinkle(0, 0, kMatrixWidth, kMatrixHeight, value, value, value);
-        gfx->show();
+        _splashing = true;
+        splash(message);
     }
+    else
+    {
+        _app.splashDone();
+    }
+    _engine.seed(esp_random());
     dlog.info(TAG, "Creating display task");
-    xTaskCreatePinnedToCore(&taskGateway<Display>, "Display", 4096, this, 1, NULL, ARDUINO_RUNNING_CORE);
-    _app.onModeChange(std::bind(&Display::modeChange, this, std::placeholders::_1));
+    xTaskCreatePinnedToCore(&taskGateway<Display>, "Display", 4096, this, 1, &_task, ARDUINO_RUNNING_CORE);
+    _app.events().subscribe(Delegate<ModeChanged>::bind<Display, &Display::modeChange>(this));
 }
 
-void Display::modeChange(AppMode mode)
+void Display::modeChange(const ModeChanged& event)
 {
-    dlog.info(TAG, "Display::modeChange: %d", mode);
+    dlog.info(TAG, "Display::modeChange: %d", event.mode);
 
     _no_clear = false;
 
-    switch (mode)
+    // boot and portal messages last until the game is up
+    if (event.mode != AppMode::STARTING)
+    {
+        post(DISPLAY_END_MESSAGES);
+    }
+
+    switch (event.mode)
     {
     case AppMode::STARTING:
         break;
@@ -174,95 +176,117 @@ void Display::modeChange(AppMode mode)
     render();
 }
 
+// scene slots, in z order
+enum
+{
+    SCENE_LHS_BACKGROUND,
+    SCENE_RHS_BACKGROUND,
+    SCENE_LHS_SCORE,
+    SCENE_RHS_SCORE,
+    SCENE_GAME_OVER,
+};
+
 void Display::getScoreSize(uint16_t* width, uint16_t* height)
 {
-    int16_t text_x1, text_y1;
-    gfx->setFont(SCORE_FONT);
-    gfx->getTextBounds("00", 0, 0, &text_x1, &text_y1, width, height);
-    *width += 4;
+    *width  = _score_width;
     *height = kMatrixHeight;
 }
 
-void Display::drawTeamBackground(Score::Team team)
+static uint32_t packColor(const CRGB& color)
+{
+    return ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b;
+}
+
+void Display::buildSide(Scene& scene, const Score::State& state, Score::Side side, int value, bool background)
 {
     uint16_t width, height;
     getScoreSize(&width, &height);
     // assume LHS
     int16_t x = 0;
-    if (_app.getSide(team) == Score::RHS)
+    if (side == Score::RHS)
     {
         x = kMatrixWidth - width;
     }
-    const rgb24& color = getTeamColor(team);
-    gfx->fillRect(x, 0, width, kMatrixHeight, gfx->Color(color.red, color.green, color.blue));
+    if (background)
+    {
+        scene.rect(SCENE_LHS_BACKGROUND + side, x, 0, width, kMatrixHeight, packColor(getTeamColor(state.getTeam(side))));
+    }
+    scene.digits(SCENE_LHS_SCORE + side, x + 2, kMatrixHeight - 3, value, packColor(SCORE_COLOR));
 }
 
-void Display::drawSide(Score::Side side, int value, bool drawBackground)
+void Display::buildScoreboard(Scene& scene, const Score::State& state)
 {
-    //Serial.printf("Display::drawSide: %d:%d\n", side, value);
+    buildSide(scene, state, Score::LHS, state.getScore(Score::LHS));
+    buildSide(scene, state, Score::RHS, state.getScore(Score::RHS));
+}
 
+void Display::buildGameOver(Scene& scene, const Score::State& state)
+{
     uint16_t width, height;
     getScoreSize(&width, &height);
     // assume LHS
-    int16_t x = 2;
-    int16_t y = kMatrixHeight - 3;
-    if (side == Score::RHS)
-    {
-        x = kMatrixWidth - width + 2;
-    }
-    Score::Team team = _app.getTeam(side);
-    gfx->setFont(SCORE_FONT);
-    if (drawBackground)
+    int16_t x = 0;
+    if (state.getSide(state.getLeader()) == Score::RHS)
     {
-        drawTeamBackground(team);
+        x = kMatrixWidth - width;
     }
-    gfx->setCursor(x, y);
-    gfx->printf("%02d", value);
+    scene.box(SCENE_GAME_OVER, x, 0, width, kMatrixHeight, packColor(_blink_state ? green : black));
 }
 
-void Display::drawScoreboard()
+/**
+ * Bring the back buffer from _rendered_scene to scene.  A full draw starts
+ * from black, otherwise only the regions that differ are repainted.
+ */
+void Display::drawScene(const Scene& scene, bool full)
 {
-    drawSide(Score::LHS, _app.getScore(Score::LHS));
-    drawSide(Score::RHS, _app.getScore(Score::RHS));
+    if (full)
+    {
+        scene.paint(_target.backBuffer(), kMatrixWidth, kMatrixHeight, _digits);
+    }
+    else
+    {
+        int rects = scene.update(_target.backBuffer(), kMatrixWidth, kMatrixHeight, _digits, _rendered_scene);
+        dlog.debug(TAG, "drawScene: repainted %d rects", rects);
+    }
+    _rendered_scene = scene;
 }
 
-void Display::drawChoices()
+void Display::drawChoices(const Score::State& state)
 {
-    drawSide(Score::LHS, 15, false);
-    drawSide(Score::RHS, 21, false);
+    Scene scene;
+    buildSide(scene, state, Score::LHS, 15, false);
+    buildSide(scene, state, Score::RHS, 21, false);
+    // drawn over the twinkle every time
+    drawScene(scene, true);
     if (!isScrolling())
     {
-        scrollingLayer.setColor(green);
-        scrollingLayer.setMode(wrapForward);
-        scrollingLayer.setSpeed(60);
-        scrollingLayer.setFont(SCROLL_FONT);
-        scrollingLayer.setOffsetFromTop(kMatrixHeight/2 - SCROLL_FONT_HIGHT/2);
-        scrollingLayer.start("Choose Game Limit", -1);
+        ScrollStyle style = {green, 60, SCROLL_FONT, kMatrixHeight/2 - SCROLL_FONT_HIGHT/2, kMatrixWidth};
+        // the long presses and swap pick the formats without a number on the panel
+        _target.startScroll("Choose 15 or 21, hold 11 or 25, swap 3x15", -1, style);
     }
 }
 
-void Display::gameOver()
+void Display::scrollGameOver()
 {
-    uint16_t width, height;
-    getScoreSize(&width, &height);
-    Score::Team team = _app.getLeader();
-
-    rgb24 box_color = black;
-
-    if (_blink_state)
+    Match::State match = _app.match();
+    Score::Team  team  = match.getLeader();
+    const char*  name  = team == Score::RED ? "Red" : "Blue";
+    int          won   = match.getGamesWon(team);
+    int          lost  = match.getGamesWon((Score::Team)(team ^ 1));
+    if (match.isMatchOver())
     {
-        box_color = green;
+        snprintf(_gameover_text, sizeof(_gameover_text), "Match %s %d-%d", name, won, lost);
     }
-
-    // assume LHS
-    int16_t x = 0;
-    if (_app.getSide(team) == Score::RHS)
+    else if (won == lost)
     {
-        x = kMatrixWidth - width;
+        snprintf(_gameover_text, sizeof(_gameover_text), "Game %d  Games %d-%d", match.getGame() + 1, won, lost);
     }
-
-    gfx->drawRect(x, 0, width, kMatrixHeight, gfx->Color(box_color.red, box_color.green, box_color.blue));
-    gfx->drawRect(x+1, 1, width-2, kMatrixHeight-2, gfx->Color(box_color.red, box_color.green, box_color.blue));
+    else
+    {
+        snprintf(_gameover_text, sizeof(_gameover_text), "Game %d  %s %d-%d", match.getGame() + 1, name, won, lost);
+    }
+    ScrollStyle style = {green, 40, GAME_OVER_FONT, kMatrixHeight/2 - GAME_OVER_FONT_HIGHT/2, 1};
+    _target.startScroll(_gameover_text, 1, style);
 }
 
 void Display::drawStarting()
@@ -271,52 +295,106 @@ void Display::drawStarting()
     int16_t w = STARTING_FONT_WIDTH * strlen(m);
     int16_t x = kMatrixWidth/2 - w/2;
     int16_t y = 0;
-    backgroundLayer.setFont(STARTING_FONT);
-    backgroundLayer.drawString(x, y, white, m);
+    _target.drawString(x, y, white, STARTING_FONT, m);
 }
 
 #ifdef RENDER_FPS
-static void renderFPS()
+void Display::renderFPS()
 {
     static char fps_display[10];
-    uint16_t real_fps = matrix.getRefreshRate();
+    uint16_t real_fps = _target.getRefreshRate();
     snprintf(fps_display, sizeof(fps_display), "%u", real_fps);
     int16_t min_x = 24; // 2 * SCORE_FONT->Width + 1;
     int16_t max_x = 40; //kMatrixWidth - (2 * SCORE_FONT->Width) + 3;
-    int16_t width = FPS_FONT->Width * strlen(fps_display);
+    int16_t width = 3 * strlen(fps_display);    // FPS_FONT is 3x5
     int16_t x = min_x + (max_x-min_x)/2 - width/2;
-    int16_t y = kMatrixHeight - FPS_FONT->Height -1;
-    backgroundLayer.setFont(FPS_FONT);
-    backgroundLayer.drawString(x, y, white, fps_display);
+    int16_t y = kMatrixHeight - 5 -1;
+    _target.drawString(x, y, white, FPS_FONT, fps_display);
 }
 #endif
 
+/**
+ * Never blocks and is safe from an ISR or timer callback: the bits are or'ed
+ * into _pending and the task is woken, it takes them all at once.
+ */
+void Display::post(uint32_t commands)
+{
+    uint32_t pending = _pending.fetch_or(commands);
+    _stats.posted((pending & commands) == commands);
+    if (_task == nullptr)
+    {
+        return; // picked up when the task starts
+    }
+    if (xPortInIsrContext())
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(_task, &woken);
+        if (woken)
+        {
+            portYIELD_FROM_ISR();
+        }
+    }
+    else
+    {
+        xTaskNotifyGive(_task);
+    }
+}
+
 void Display::render()
 {
-    dlog.info(TAG, "render() before queue size: %u", uxQueueMessagesWaiting(_queue));
-    const char* cmd = CMD_RENDER;
-    // Send a pointer to a struct const char*.  Don't block if the
-    // queue is already full.
-   xQueueSend( _queue, &cmd, ( TickType_t ) 100 / portTICK_PERIOD_MS );
+    dlog.debug(TAG, "render()");
+    post(DISPLAY_RENDER);
+}
+
+void Display::changed(const ScoreChanged& event)
+{
+    // a newer version may already be on the panel
+    if (event.version <= _rendered_version)
+    {
+        dlog.debug(TAG, "changed: skipping version: %u changes: 0x%02x", event.version, event.changes);
+        return;
+    }
+    // the oldest change waiting is the one the latency is measured from
+    uint32_t none = 0;
+    _changed_at.compare_exchange_strong(none, event.at_us | 1);
+    render();
 }
 
 void Display::doRender()
 {
     dlog.info(TAG, "doRender()");
-    if (!_no_clear)
+    // anything published after this is stamped again for the next render
+    uint32_t changed_at = _changed_at.exchange(0);
+    if (changed_at != 0)
+    {
+        _render_changed_at = changed_at;
+    }
+    // render everything from one consistent copy of the score
+    uint32_t version = _app.version();
+    Score::State state = _app.snapshot();
+    bool full = !_no_clear;
+    if (full)
     {
-        backgroundLayer.fillScreen(black);
+        _target.fillScreen(black);
+        _rendered_scene.clear();
     }
+    Scene scene;
 
     switch (_app.mode())
     {
     case AppMode::STARTING:
+        if (_resumed)
+        {
+            // the restored score, a RESUME applied later renders again
+            buildScoreboard(scene, state);
+            drawScene(scene, full);
+            break;
+        }
         drawStarting();
-        doMessage(_message);
         break;
 
     case AppMode::CHOOSING:
-        drawChoices();
+        drawChoices(state);
         break;
 
     case AppMode::RUNNING:
@@ -325,7 +403,8 @@ void Display::doRender()
             _no_clear = true;
         }
         doStopScrolling();
-        drawScoreboard();
+        buildScoreboard(scene, state);
+        drawScene(scene, full);
         break;
 
     case AppMode::GAME_OVER:
@@ -333,209 +412,322 @@ void Display::doRender()
         {
             _no_clear = true;
         }
-        drawScoreboard();
-        gameOver();
+        // a blink only repaints the box outline
+        buildScoreboard(scene, state);
+        buildGameOver(scene, state);
+        drawScene(scene, full);
     }
  
  #ifdef RENDER_FPS
     renderFPS();
  #endif
-    gfx->show();
+    _rendered_version = version;
 }
 
 void Display::doTwinkle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t r, uint8_t g, uint8_t b, size_t count)
 {
-    int16_t x0, y0;
+    _engine.twinkle(_target.backBuffer(), kMatrixWidth, x, y, width, height, CRGB(r, g, b), count);
+}
 
-    if (count == 0)
+void Display::doPixels(const Score::State& state, int16_t x, int16_t y, uint16_t width, uint16_t height, size_t count)
+{
+    const unsigned int transitionTime = 3000;
+
+    // the leader's color breathes down to black and back
+    uint8_t level = EffectEngine::fade(millis(), transitionTime);
+    if (state.getLeader() == Score::Team::RED)
     {
-        count = (width + height) / 2;
+        doTwinkle(x, y, width, height, level, 0, 0, count);
     }
-
-    // turn some on
-    for (size_t i = 0; i < count; i++) {
-        x0 = x + random(width);
-        y0 = y + random(height);
-
-        gfx->drawPixel(x0, y0, gfx->Color(r, g, b));
+    else
+    {
+        doTwinkle(x, y, width, height, 0, 0, level, count);
     }
+}
 
-    // and some off
-    for (size_t i = 0; i < count; i++) {
-        x0 = x + random(width);
-        y0 = y + random(height);
-
-        gfx->drawPixel(x0, y0, gfx->Color(0,0,0));
+/**
+ * Effects were tuned for one step per period_ms, scale a per step count to
+ * the time since the last frame so the look does not depend on the frame
+ * rate, and by the effect quality so busy frames draw fewer pixels.  The
+ * fraction is rounded at random so small counts still show.
+ */
+size_t Display::effectCount(size_t count, uint32_t elapsed_us, uint32_t period_ms)
+{
+    uint32_t units  = (uint64_t)count * _effects.quality() * (elapsed_us / 100) / EFFECT_QUALITY_FULL;
+    uint32_t scaled = units / (period_ms * 10);
+    uint32_t rest   = units % (period_ms * 10);
+    if (rest && _engine.below(period_ms * 10) < rest)
+    {
+        ++scaled;
     }
+    return scaled;
 }
 
-void Display::doPixels(int16_t x, int16_t y, uint16_t width, uint16_t height)
+void Display::takeCommands()
 {
-    static unsigned long currentMillis = 0;
-    const unsigned int transitionTime = 3000;
-
-    if (millis() - currentMillis < transitionTime)
+    uint32_t commands = _pending.exchange(0);
+    if (commands == 0)
     {
-        currentMillis = millis();
+        return;
     }
+    dlog.debug(TAG, "takeCommands: 0x%02x", commands);
 
-    rgb24 color;
-    float fraction = ((float)millis() - currentMillis) / ((float)transitionTime / 2);
-
-    Score::Team team = _app.getLeader();
- 
-    if (team == Score::Team::RED) 
+    if (commands & DISPLAY_STOP_SCROLL)
+    {
+        doStopScrolling();
+    }
+    if (commands & DISPLAY_SCROLL_GAMEOVER)
+    {
+        scrollGameOver();
+    }
+    if (commands & DISPLAY_END_MESSAGES)
     {
-        color.red = 255 - 255.0 * fraction;
-        color.green = 0;
-        color.blue = 0;
+        _overlays.clearUntimed();
     }
-    else 
+    uint32_t overlays = 0;
+    if (commands & DISPLAY_OVERLAY)
     {
-        color.red = 0;
-        color.green = 0;
-        color.blue = 255 - 255.0 * fraction;
+        Overlay overlay;
+        while (_posted.pop(overlay))
+        {
+            if (!_overlays.add(overlay, millis()))
+            {
+                dlog.warning(TAG, "takeCommands: overlays full, dropped '%s'", overlay.text);
+            }
+            ++overlays;
+        }
     }
+    _stats.taken(overlays);
+    _dirty = true;
+}
 
-    doTwinkle(x, y, width, height, color.red, color.green, color.blue);
+void Display::animate(uint32_t elapsed_us)
+{
+    uint16_t width, height;
+    getScoreSize(&width, &height);
+    int16_t x = width;
+    int16_t y = 0;
+    width = kMatrixWidth - 2 * width;
+    const uint8_t blue_boost = 60; // the panel I am using red seems brighter than blue
+    Score::State state = _app.snapshot();
+    if (_splashing)
+    {
+        if (isScrolling())
+        {
+            uint8_t value = _engine.below(255);
+            doTwinkle(0, 0, kMatrixWidth, kMatrixHeight, value, value, value,
+                      effectCount((kMatrixWidth + kMatrixHeight) / 2, elapsed_us, SPLASH_PERIOD_MS));
+        }
+        else
+        {
+            _splashing = false;
+            _app.splashDone();
+        }
+    }
+    else if (_app.mode() == AppMode::GAME_OVER)
+    {
+        // the box is retained in the scene, only the middle animates
+        doPixels(state, x, y, width, height, effectCount((width + height) / 2, elapsed_us, EFFECT_PERIOD_MS));
+    }
+    else if (_app.mode() == AppMode::CHOOSING)
+    {
+        uint8_t pixel = _engine.below(255-blue_boost);
+        size_t  count = effectCount(width + height, elapsed_us, EFFECT_PERIOD_MS);
+        doTwinkle(0, 0, kMatrixWidth, kMatrixHeight, pixel, 0, 0, count);
+        doTwinkle(0, 0, kMatrixWidth, kMatrixHeight, 0, 0, pixel+blue_boost, count);
+        drawChoices(state);
+    }
+    else if (_app.mode() == AppMode::RUNNING)
+    {
+        int red_score = state.getTeamScore(Score::Team::RED);
+        int blue_score = state.getTeamScore(Score::Team::BLUE);
+        int count = blue_score+red_score;
+        if (count < 1)
+        {
+            count = 1;
+        }
+        uint8_t pixel = _engine.below(255);
+        doTwinkle(x, y, width, height, pixel, pixel, pixel, effectCount(count, elapsed_us, EFFECT_PERIOD_MS));
+    }
 }
 
+/**
+ * Frames run on a fixed period from _frames.  Commands that arrive before
+ * the deadline are taken at once but only mark the scene dirty, so a burst
+ * collapses into a single render in the next frame and never starves the
+ * animation.
+ */
 void Display::task()
 {
-    const char* message = nullptr;
+    uint32_t    logged  = millis();
+    _frames.begin(micros());
     while(true) 
     {
-        UBaseType_t cnt = uxQueueMessagesWaiting(_queue);
-        dlog.trace(TAG, "loop: queue size: %u", cnt);
-
-        if (xQueueReceive(_queue, &message, 100 / portTICK_PERIOD_MS ) == pdTRUE)
+        uint32_t wait_us = _frames.untilDeadline(micros());
+        TickType_t wait = wait_us / 1000 / portTICK_PERIOD_MS;
+        if (wait > 0)
         {
-            dlog.info(TAG, "loop: item from queue: 0x%08x", message);
+            ulTaskNotifyTake(pdTRUE, wait);
+        }
+        takeCommands();
+        if (_frames.untilDeadline(micros()) > 1000)
+        {
+            continue;
+        }
 
-            if (message == CMD_STOP_SCROLL)
-            {
-                doStopScrolling();
-            }
-            else if (message == CMD_BLINK)
-            {
-                _blink_state = !_blink_state;
-            }
-            else if (message == CMD_SCROLL_GAMEOVER)
-            {
-                scrollingLayer.setColor(green);
-                scrollingLayer.setMode(wrapForward);
-                scrollingLayer.setSpeed(40);
-                scrollingLayer.setFont(GAME_OVER_FONT);
-                scrollingLayer.setStartOffsetFromLeft(1);
-                scrollingLayer.setOffsetFromTop(kMatrixHeight/2 - GAME_OVER_FONT_HIGHT/2);
-                scrollingLayer.start("Game Over", 1);
-            }
-            else if (message != nullptr)
-            {
-                _message = message;
-            }
+        // the score goes first and is never scaled, only the effects are
+        _frames.frameStart(micros());
+        if (_dirty)
+        {
+            _dirty = false;
+            uint32_t start = micros();
             doRender();
+            _stats.rendered(micros() - start);
         }
-        else
+        animate(_frames.elapsed());
+        drawOverlay();
+        drawStats();
+        _target.show();
+        uint32_t shown = micros();
+        if (_render_changed_at != 0)
         {
-            uint16_t width, height;
-            getScoreSize(&width, &height);
-            int16_t x = width;
-            int16_t y = 0;
-            width = kMatrixWidth - 2 * width;
-            const uint8_t blue_boost = 60; // the panel I am using red seems brighter than blue
-            if (_app.mode() == AppMode::GAME_OVER)
-            {
-                gameOver();
-                doPixels(x, y, width, height);
-            }
-            else if (_app.mode() == AppMode::CHOOSING)
-            {
-                uint8_t pixel = random(255-blue_boost);
-                doTwinkle(0, 0, kMatrixWidth, kMatrixHeight, pixel, 0, 0, width+height);
-                doTwinkle(0, 0, kMatrixWidth, kMatrixHeight, 0, 0, pixel+blue_boost, width+height);
-                drawChoices();
-            }
-            else if (_app.mode() == AppMode::RUNNING)
-            {
-                int red_score = _app.getScore(_app.getSide(Score::Team::RED));
-                int blue_score = _app.getScore(_app.getSide(Score::Team::BLUE));
-                int count = blue_score+red_score;
-                if (count < 1)
-                {
-                    count = 1;
-                }
-                uint8_t pixel = random(255);
-                doTwinkle(x, y, width, height, pixel, pixel, pixel, count);
-            }
-            gfx->show();
+            _stats.changeShown(shown - _render_changed_at);
+            _render_changed_at = 0;
+        }
+        _frames.frameEnd(shown);
+        _effects.update(_frames.stats().last_frame_us, _frames.getBudget());
+        _stats.frame(_frames.stats(), millis(), _target.getRefreshRate());
+
+        if (millis() - logged >= FRAME_STATS_LOG_MS)
+        {
+            const FrameStats& stats = _frames.stats();
+            dlog.debug(TAG, "frames: %u overruns: %u skipped: %u jitter: %u/%u us frame: %u/%u us quality: %u/%u cuts: %u",
+                       stats.frames, stats.overruns, stats.skipped,
+                       stats.last_jitter_us, stats.max_jitter_us,
+                       stats.last_frame_us, stats.max_frame_us,
+                       _effects.quality(), EFFECT_QUALITY_FULL, _effects.reductions());
+            logged = millis();
         }
     }
 }
 
 void Display::splash(const char* message)
 {
-    scrollingLayer.setColor(green);
-    scrollingLayer.setMode(wrapForward);
-    scrollingLayer.setSpeed(60);
-    scrollingLayer.setFont(SCROLL_FONT);
-    scrollingLayer.setOffsetFromTop(kMatrixHeight/2 - SCROLL_FONT_HIGHT/2);
-    scrollingLayer.start(message, 1);
+    ScrollStyle style = {green, 60, SCROLL_FONT, kMatrixHeight/2 - SCROLL_FONT_HIGHT/2, kMatrixWidth};
+    _target.startScroll(message, 1, style);
 }
 
+// stays up until another status message replaces it
 void Display::message(const char* message)
 {
-    dlog.info(TAG, "message: '%s' before queue size: %u", message, uxQueueMessagesWaiting(_queue));
-    // Send a pointer to a const char*.  Don't block if the
-    // queue is already full.
-    if (xQueueSend( _queue, &message, ( TickType_t ) 100 / portTICK_PERIOD_MS ) != pdTRUE)
+    overlay(message, 0, OVERLAY_PRIORITY_STATUS);
+}
+
+/**
+ * Show text over the middle of the panel for duration_ms (0 until replaced)
+ * once the display gets to it, dropped if it is not up within expire_ms
+ * (0 never).  The text is copied and the call never blocks.
+ */
+void Display::overlay(const char* text, uint32_t duration_ms, uint8_t priority, uint32_t expire_ms)
+{
+    dlog.info(TAG, "overlay: '%s' for %u ms priority %u", text, duration_ms, priority);
+    Overlay overlay;
+    strncpy(overlay.text, text, sizeof(overlay.text) - 1);
+    overlay.text[sizeof(overlay.text) - 1] = '\0';
+    overlay.duration_ms = duration_ms;
+    overlay.expire_ms   = expire_ms;
+    overlay.priority    = priority;
+    if (!_posted.push(overlay))
+    {
+        dlog.error(TAG, "overlay: failed to queue overlay!");
+        return;
+    }
+    post(DISPLAY_OVERLAY);
+}
+
+void Display::drawOverlay()
+{
+    const Overlay* overlay = _overlays.update(millis());
+    if (overlay == nullptr)
     {
-        dlog.error(TAG, "message: failed to queue message!");
+        if (_overlay_up)
+        {
+            // it covered part of the scene, draw it all again
+            _overlay_up = false;
+            _no_clear   = false;
+            _dirty      = true;
+        }
+        return;
+    }
+    _overlay_up = true;
+    _target.fillRectangle(0, kMatrixHeight/2 - STARTING_FONT_HIGHT/2 - 1,
+                          kMatrixWidth - 1, kMatrixHeight/2 + STARTING_FONT_HIGHT/2 + 1, black);
+    doMessage(overlay->text);
+}
+
+/**
+ * Two rows of telemetry along the top while RenderStats::overlay() is set:
+ * frames per second / panel refresh and dropped frames, then the render
+ * time in us and the change to panel latency in ms, both 99th percentile.
+ */
+void Display::drawStats()
+{
+    if (!_stats.overlay())
+    {
+        if (_stats_up)
+        {
+            _stats_up = false;
+            _no_clear = false;
+            _dirty    = true;
+        }
+        return;
     }
-    delay(250); // short delay to insure message is displayed for a short time at least.
+    _stats_up = true;
+    char line[17];  // 16 characters of the 3x5 font fill the width
+    _target.fillRectangle(0, 0, kMatrixWidth - 1, 2 * STATS_LINE_HIGHT, black);
+    snprintf(line, sizeof(line), "%u/%uHZ D%u", _stats.fps(), _stats.refreshRate(), _stats.dropped());
+    _target.drawString(1, 1, white, STATS_FONT, line);
+    snprintf(line, sizeof(line), "R%u L%u", _stats.render().percentile(99), _stats.latency().percentile(99) / 1000);
+    _target.drawString(1, 1 + STATS_LINE_HIGHT, white, STATS_FONT, line);
 }
 
 void Display::doMessage(const char* message)
 {
     if (message)
     {
-        dlog.info(TAG, "doMessage: %s", message);
+        dlog.trace(TAG, "doMessage: %s", message);
         int16_t w = STARTING_FONT_WIDTH * strlen(message);
         int16_t h = STARTING_FONT_HIGHT;
         int16_t x = kMatrixWidth/2 - w/2;
         int16_t y = kMatrixHeight/2 - h/2;
-        backgroundLayer.setFont(STARTING_FONT);
-        backgroundLayer.drawString(x, y, orange, message);
+        _target.drawString(x, y, orange, STARTING_FONT, message);
     }
 }
 
 bool Display::isScrolling()
 {
-    return scrollingLayer.getStatus() != 0;
+    return _target.getScrollStatus() != 0;
 }
 
 void Display::stopScrolling()
 {
-    dlog.info(TAG, "stopScrolling() before queue size: %u", uxQueueMessagesWaiting(_queue));
-    // Send a pointer to a struct const char*.  Don't block if the
-    // queue is already full.
-    const char* ss = (const char*)1;
-    xQueueSend( _queue, &ss, ( TickType_t ) 100 / portTICK_PERIOD_MS );
+    dlog.info(TAG, "stopScrolling()");
+    post(DISPLAY_STOP_SCROLL | DISPLAY_RENDER);
 }
 
 void Display::doStopScrolling()
 {
-    scrollingLayer.stop();
+    _target.stopScroll();
 }
 
 void Display::queueBlink(Display* display)
 {
-    const char* cmd = CMD_BLINK;
-    xQueueSendFromISR(display->_queue, &cmd, nullptr);
+    // blink is state, not a command, a missed frame just shows the newer state
+    display->_blink_state = !display->_blink_state;
+    display->post(DISPLAY_RENDER);
 }
 
 void Display::queueScrollGameOver(Display* display)
 {
-    const char* cmd = CMD_SCROLL_GAMEOVER;
-    xQueueSendFromISR(display->_queue, &cmd, nullptr);
+    display->post(DISPLAY_SCROLL_GAMEOVER | DISPLAY_RENDER);
 }
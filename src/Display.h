@@ -34,44 +34,104 @@
 #include "App.h"
 #include "Ticker.h"
 #include "TaskGateway.h"
+#include "DigitAtlas.h"
+#include "Scene.h"
+#include "FrameScheduler.h"
+#include "EffectEngine.h"
+#include "LockFreeQueue.h"
+#include "OverlayQueue.h"
+#include "RenderTarget.h"
+#include "RenderStats.h"
+#include <atomic>
+
+#ifndef DISPLAY_MESSAGE_QUEUE_SIZE
+#define DISPLAY_MESSAGE_QUEUE_SIZE  4
+#endif
+
+/**
+ * Commands to the Display task are bits, posting one that is already
+ * pending is a no-op so any number of renders collapse into one.
+ */
+enum DisplayCommand : uint32_t
+{
+    DISPLAY_RENDER          = 1 << 0,   // redraw the scene
+    DISPLAY_STOP_SCROLL     = 1 << 1,   // stop scrolling
+    DISPLAY_SCROLL_GAMEOVER = 1 << 2,   // scroll the game over text, once a minute
+    DISPLAY_OVERLAY         = 1 << 3,   // an Overlay is queued
+    DISPLAY_END_MESSAGES    = 1 << 4,   // drop overlays that have no duration
+};
 
 class Display
 {
 public:
-    Display(App& app);
+    Display(App& app, RenderTarget& target);
     virtual ~Display();
-    void begin(const char* message);
+    void begin(const char* message, bool show_splash = true);
     void render();
+    void changed(const ScoreChanged& event);
     void message(const char* message);
+    void overlay(const char* text, uint32_t duration_ms, uint8_t priority = OVERLAY_PRIORITY_STATUS, uint32_t expire_ms = 0);
     void splash(const char* message);
     bool isScrolling();
     void stopScrolling();
-    void modeChange(AppMode mode);
+    void modeChange(const ModeChanged& event);
+    const FrameStats& frameStats() const { return _frames.stats(); }
+    uint16_t effectQuality() const { return _effects.quality(); }
 
 private:
     App&                    _app;
-    QueueHandle_t           _queue;
-    const char* volatile    _message;       // Starting messages
-    bool                    _blink_state;   // blink is on or off
+    RenderTarget&           _target;
+    TaskHandle_t            _task;
+    std::atomic<uint32_t>   _pending;       // DisplayCommand bits not yet taken by the task
+    MpscQueue<Overlay, DISPLAY_MESSAGE_QUEUE_SIZE> _posted;   // overlays on their way to the task
+    OverlayQueue            _overlays;      // owned by the task
+    bool                    _overlay_up;    // an overlay was drawn last frame
+    std::atomic<bool>       _blink_state;   // blink is on or off, flipped by the blink timer
     bool                    _no_clear;      // don't clear first on render
+    volatile bool           _splashing;     // splash message still scrolling
+    bool                    _resumed;       // a saved game was restored, STARTING shows its score
+    Scene                   _rendered_scene;    // background layer as last drawn
+    volatile uint32_t       _rendered_version;  // App version as last drawn
     Ticker                  _blinker;
     Ticker                  _gameover;
+    char                    _gameover_text[40];   // scrolled between games
+    DigitAtlas              _digits;        // score font digits, built in begin()
+    uint16_t                _score_width;   // "00" plus margin, measured once
+    FrameScheduler          _frames;
+    EffectGovernor          _effects;       // twinkle density under the frame budget
+    EffectEngine            _engine;
+    bool                    _dirty;         // commands arrived, render in the next frame
+    RenderStats&            _stats;
+    bool                    _stats_up;      // the stats overlay was drawn last frame
+    std::atomic<uint32_t>   _changed_at;    // micros() of the oldest change not rendered yet, 0 none
+    uint32_t                _render_changed_at; // taken by the last render, 0 once shown
 
     static void queueBlink(Display* display);
     static void queueScrollGameOver(Display* display);
     void getScoreSize(uint16_t* width, uint16_t* height);
-    void drawTeamBackground(Score::Team team);
-    void drawSide(Score::Side side, int value, bool drawBackground = true);
-    void drawScoreboard();
-    void drawChoices();
-    void gameOver();
+    void buildSide(Scene& scene, const Score::State& state, Score::Side side, int value, bool background = true);
+    void buildScoreboard(Scene& scene, const Score::State& state);
+    void buildGameOver(Scene& scene, const Score::State& state);
+    void drawScene(const Scene& scene, bool full);
+    void drawChoices(const Score::State& state);
+    void scrollGameOver();
     void drawStarting();
+#ifdef RENDER_FPS
+    void renderFPS();
+#endif
     void doRender();
     void doMessage(const char* message);
+    void drawOverlay();
+    void drawStats();
     void doStopScrolling();
-    void doTwinkle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t r, uint8_t g, uint8_t b, size_t count = 0);
-    void doPixels(int16_t x, int16_t y, uint16_t width, uint16_t height);
+    void doTwinkle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t r, uint8_t g, uint8_t b, size_t count);
+    void doPixels(const Score::State& state, int16_t x, int16_t y, uint16_t width, uint16_t height, size_t count);
+    void post(uint32_t commands);
+    void takeCommands();
+    void animate(uint32_t elapsed_us);
+    size_t effectCount(size_t count, uint32_t elapsed_us, uint32_t period_ms);
     void task();
     friend void taskGateway<Display>(void*data);
+    friend class RenderBench;   // bench/RenderBench.cpp times the render paths one by one
 };
 #endif
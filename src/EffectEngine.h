@@ -0,0 +1,112 @@
+/**
+ * @file EffectEngine.h
+ * @author Christoper B. Liebman
+ * @brief twinkle and fade effects written straight into the pixel buffer
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef EFFECT_ENGINE_H_
+#define EFFECT_ENGINE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define EFFECT_BATCH 32     // pixel offsets generated before any are written
+
+/**
+ * Particle style effects for the background layer.  A xorshift32 generator
+ * replaces Arduino random() (a call into the esp_random() hardware RNG),
+ * positions are generated a batch at a time and written by index straight
+ * into the row-major buffer instead of through the GFX drawPixel().  No
+ * hardware dependencies, PIXEL needs a PIXEL(r, g, b) constructor.
+ */
+class EffectEngine
+{
+public:
+    explicit EffectEngine(uint32_t seed = 0x2545f491) : _state(seed ? seed : 1) {}
+
+    void seed(uint32_t seed) { _state = seed ? seed : 1; }
+
+    uint32_t next()
+    {
+        uint32_t x = _state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return _state = x;
+    }
+
+    // 0 to n-1 without a divide
+    uint32_t below(uint32_t n) { return ((uint64_t)next() * n) >> 32; }
+
+    // count random pixels in the rectangle set to color, then count set to black
+    template<class PIXEL>
+    void twinkle(PIXEL* buffer, int stride, int x, int y, int width, int height, const PIXEL& color, size_t count)
+    {
+        if (width <= 0 || height <= 0)
+        {
+            return;
+        }
+        scatter(buffer, stride, x, y, width, height, color, count);
+        scatter(buffer, stride, x, y, width, height, PIXEL(0, 0, 0), count);
+    }
+
+    /**
+     * Triangle wave from 255 down to 0 and back over period_ms, 8.8 fixed
+     * point instead of the float fraction doPixels() used to compute.
+     */
+    static uint8_t fade(uint32_t now_ms, uint32_t period_ms)
+    {
+        uint32_t half  = period_ms / 2;
+        uint32_t phase = now_ms % period_ms;
+        uint32_t t     = phase < half ? phase : period_ms - phase;     // 0 to half
+        uint32_t step  = (255u << 8) / half;
+        return 255 - ((t * step) >> 8);
+    }
+
+private:
+    uint32_t _state;
+
+    template<class PIXEL>
+    void scatter(PIXEL* buffer, int stride, int x, int y, int width, int height, const PIXEL& color, size_t count)
+    {
+        PIXEL*   origin = buffer + y * stride + x;
+        uint32_t offsets[EFFECT_BATCH];
+        while (count > 0)
+        {
+            size_t batch = count < EFFECT_BATCH ? count : EFFECT_BATCH;
+            for (size_t i = 0; i < batch; ++i)
+            {
+                offsets[i] = below(height) * stride + below(width);
+            }
+            for (size_t i = 0; i < batch; ++i)
+            {
+                origin[offsets[i]] = color;
+            }
+            count -= batch;
+        }
+    }
+};
+
+#endif // EFFECT_ENGINE_H_
@@ -0,0 +1,115 @@
+/**
+ * @file EventBus.h
+ * @author Christoper B. Liebman
+ * @brief fixed capacity publish/subscribe channels
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef EVENT_BUS_H_
+#define EVENT_BUS_H_
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include "Delegate.h"
+
+#define EVENT_FILTER_ALL 0xffffffff
+
+/**
+ * Handle returned by subscribe(), pass it back to unsubscribe().
+ */
+template<class E>
+struct Subscription
+{
+    int slot;
+    bool valid() const { return slot >= 0; }
+};
+
+/**
+ * Fixed number of subscribers for one event type.  Events provide a
+ * filterMask() and a subscriber only sees events where that mask overlaps
+ * the filter it subscribed with.  publish() only reads atomics and calls
+ * delegates: no locks and no allocation.
+ */
+template<class E, size_t SIZE>
+class EventChannel
+{
+public:
+    EventChannel()
+    {
+        for (size_t i = 0; i < SIZE; ++i)
+        {
+            _slots[i].state.store(FREE, std::memory_order_relaxed);
+        }
+    }
+
+    Subscription<E> subscribe(Delegate<E> delegate, uint32_t filter = EVENT_FILTER_ALL)
+    {
+        for (size_t i = 0; i < SIZE; ++i)
+        {
+            uint8_t expected = FREE;
+            if (_slots[i].state.compare_exchange_strong(expected, CLAIMED, std::memory_order_acquire))
+            {
+                _slots[i].delegate = delegate;
+                _slots[i].filter   = filter;
+                _slots[i].state.store(ACTIVE, std::memory_order_release);
+                return {(int)i};
+            }
+        }
+        return {-1};
+    }
+
+    void unsubscribe(Subscription<E> subscription)
+    {
+        if (subscription.valid() && subscription.slot < (int)SIZE)
+        {
+            _slots[subscription.slot].state.store(FREE, std::memory_order_release);
+        }
+    }
+
+    void publish(const E& event) const
+    {
+        uint32_t mask = event.filterMask();
+        for (size_t i = 0; i < SIZE; ++i)
+        {
+            const Slot& slot = _slots[i];
+            if (slot.state.load(std::memory_order_acquire) == ACTIVE && (slot.filter & mask) != 0)
+            {
+                slot.delegate(event);
+            }
+        }
+    }
+
+private:
+    enum {FREE, CLAIMED, ACTIVE};
+    struct Slot
+    {
+        std::atomic<uint8_t> state;
+        Delegate<E>          delegate;
+        uint32_t             filter;
+    };
+    Slot _slots[SIZE];
+};
+
+#endif // EVENT_BUS_H_
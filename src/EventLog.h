@@ -0,0 +1,97 @@
+/**
+ * @file EventLog.h
+ * @author Christoper B. Liebman
+ * @brief fixed size undo/redo log
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef EVENT_LOG_H_
+#define EVENT_LOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Ring of the last SIZE entries with a cursor between what has been applied
+ * and what can be redone.  Recording drops anything past the cursor (and
+ * the oldest entry once full), undo() and redo() only move the cursor.
+ * Single writer, not thread safe.  SIZE must be a power of 2.
+ */
+template<class T, size_t SIZE>
+class EventLog
+{
+    static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of 2");
+
+public:
+    EventLog() : _head(0), _cursor(0), _tail(0) {}
+
+    void record(const T& entry)
+    {
+        _tail = _cursor;
+        if (_tail - _head >= SIZE)
+        {
+            ++_head; // full, forget the oldest
+        }
+        _items[_tail & (SIZE - 1)] = entry;
+        _cursor = ++_tail;
+    }
+
+    // entry to take back, false if there is nothing left to undo
+    bool undo(T& entry)
+    {
+        if (_cursor == _head)
+        {
+            return false;
+        }
+        entry = _items[--_cursor & (SIZE - 1)];
+        return true;
+    }
+
+    // entry to apply again, false if nothing has been undone
+    bool redo(T& entry)
+    {
+        if (_cursor == _tail)
+        {
+            return false;
+        }
+        entry = _items[_cursor++ & (SIZE - 1)];
+        return true;
+    }
+
+    size_t undoCount() const { return _cursor - _head; }
+    size_t redoCount() const { return _tail - _cursor; }
+
+    void clear()
+    {
+        _head = _cursor = _tail = 0;
+    }
+
+private:
+    T      _items[SIZE];
+    size_t _head;     // oldest entry still kept
+    size_t _cursor;   // next entry to redo
+    size_t _tail;     // one past the newest entry
+};
+
+#endif // EVENT_LOG_H_
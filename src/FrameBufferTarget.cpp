@@ -0,0 +1,206 @@
+/**
+ * @file FrameBufferTarget.cpp
+ * @author Christoper B. Liebman
+ * @brief render target in memory, composed frames to hash and export
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#include "FrameBufferTarget.h"
+#include <esp_timer.h>
+#include <stdio.h>
+#include <string.h>
+
+// cell sizes of the SmartMatrix fonts, same order as RenderFont
+static const uint8_t font_widths[]  = { 3, 5, 6, 8, 6, 6 };
+static const uint8_t font_heights[] = { 5, 7, 10, 13, 11, 11 };
+
+FrameBufferTarget::FrameBufferTarget(uint16_t width, uint16_t height)
+: _width(width),
+  _height(height),
+  _back(new CRGB[width * height]),
+  _front(new CRGB[width * height]),
+  _frame(new CRGB[width * height]),
+  _shows(0),
+  _text(),
+  _style(),
+  _scrolls(0),
+  _started(0)
+{
+}
+
+FrameBufferTarget::~FrameBufferTarget()
+{
+    delete[] _back;
+    delete[] _front;
+    delete[] _frame;
+}
+
+int FrameBufferTarget::fontWidth(RenderFont font)
+{
+    return font_widths[font];
+}
+
+int FrameBufferTarget::fontHeight(RenderFont font)
+{
+    return font_heights[font];
+}
+
+void FrameBufferTarget::begin(uint8_t brightness)
+{
+    (void)brightness;   // frames are kept at full brightness
+    fillScreen(CRGB(0, 0, 0));
+    show();
+    _shows = 0;
+}
+
+void FrameBufferTarget::fillScreen(const CRGB& color)
+{
+    for (int i = 0; i < _width * _height; ++i)
+    {
+        _back[i] = color;
+    }
+}
+
+void FrameBufferTarget::fillRectangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, const CRGB& color)
+{
+    x0 = x0 < 0 ? 0 : x0;
+    y0 = y0 < 0 ? 0 : y0;
+    x1 = x1 >= _width ? _width - 1 : x1;
+    y1 = y1 >= _height ? _height - 1 : y1;
+    for (int16_t y = y0; y <= y1; ++y)
+    {
+        CRGB* line = _back + y * _width;
+        for (int16_t x = x0; x <= x1; ++x)
+        {
+            line[x] = color;
+        }
+    }
+}
+
+void FrameBufferTarget::text(CRGB* buffer, int16_t x, int16_t y, const CRGB& color, RenderFont font, const char* text)
+{
+    int w = font_widths[font];
+    int h = font_heights[font];
+    for (; *text; ++text, x += w)
+    {
+        if (*text == ' ')
+        {
+            continue;
+        }
+        // a cell one column narrower than the advance so letters stay apart
+        for (int row = y < 0 ? 0 : y; row < y + h && row < _height; ++row)
+        {
+            for (int col = x < 0 ? 0 : x; col < x + w - 1 && col < _width; ++col)
+            {
+                buffer[row * _width + col] = color;
+            }
+        }
+    }
+}
+
+void FrameBufferTarget::drawString(int16_t x, int16_t y, const CRGB& color, RenderFont font, const char* text)
+{
+    this->text(_back, x, y, color, font, text);
+}
+
+void FrameBufferTarget::show()
+{
+    CRGB* shown = _back;
+    _back  = _front;
+    _front = shown;
+    memcpy(_back, _front, _width * _height * sizeof(CRGB));
+    compose();
+    _shows++;
+}
+
+void FrameBufferTarget::startScroll(const char* text, int scrolls, const ScrollStyle& style)
+{
+    strncpy(_text, text, sizeof(_text) - 1);
+    _text[sizeof(_text) - 1] = '\0';
+    _style   = style;
+    _scrolls = scrolls;
+    _started = esp_timer_get_time();
+}
+
+void FrameBufferTarget::stopScroll()
+{
+    _scrolls = 0;
+}
+
+int64_t FrameBufferTarget::passTime() const
+{
+    int pixels = _style.left + (int)strlen(_text) * font_widths[_style.font];
+    return (int64_t)pixels * 1000000 / (_style.speed ? _style.speed : 1);
+}
+
+int FrameBufferTarget::getScrollStatus()
+{
+    if (_scrolls <= 0)
+    {
+        return _scrolls;
+    }
+    int64_t passes = (esp_timer_get_time() - _started) / passTime();
+    return passes >= _scrolls ? 0 : _scrolls - (int)passes;
+}
+
+void FrameBufferTarget::compose()
+{
+    memcpy(_frame, _front, _width * _height * sizeof(CRGB));
+    if (getScrollStatus() == 0)
+    {
+        return;
+    }
+    int64_t into = (esp_timer_get_time() - _started) % passTime();
+    int16_t x    = _style.left - (int16_t)(into * _style.speed / 1000000);
+    text(_frame, x, _style.top, _style.color, _style.font, _text);
+}
+
+uint64_t FrameBufferTarget::hash() const
+{
+    uint64_t       hash  = 14695981039346656037ULL;
+    const uint8_t* bytes = (const uint8_t*)_frame;
+    for (size_t i = 0; i < _width * _height * sizeof(CRGB); ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// binary P6, any image tool converts it to PNG
+bool FrameBufferTarget::writePPM(const char* path) const
+{
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    fprintf(file, "P6\n%u %u\n255\n", _width, _height);
+    for (int i = 0; i < _width * _height; ++i)
+    {
+        uint8_t rgb[3] = { _frame[i].r, _frame[i].g, _frame[i].b };
+        fwrite(rgb, 1, sizeof(rgb), file);
+    }
+    return fclose(file) == 0;
+}
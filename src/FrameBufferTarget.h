@@ -0,0 +1,93 @@
+/**
+ * @file FrameBufferTarget.h
+ * @author Christoper B. Liebman
+ * @brief render target in memory, composed frames to hash and export
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#ifndef FRAME_BUFFER_TARGET_H_
+#define FRAME_BUFFER_TARGET_H_
+
+#include "RenderTarget.h"
+
+#define FRAME_BUFFER_TEXT_SIZE 48
+
+/**
+ * Keeps the background double buffered like the SmartMatrix layer and on
+ * every show() composes it with the scrolling text into frame(), the
+ * pixels the panel would show.  Text uses the SmartMatrix font cell sizes
+ * but draws each glyph as a solid cell, the bitmap fonts live in the
+ * SmartMatrix library.  Scrolling runs on esp_timer_get_time() so a run on
+ * the NativeHal virtual clock gives the same frames every time.
+ */
+class FrameBufferTarget : public RenderTarget
+{
+public:
+    FrameBufferTarget(uint16_t width, uint16_t height);
+    virtual ~FrameBufferTarget();
+    // owns its buffers, a copy would free them twice
+    FrameBufferTarget(const FrameBufferTarget&) = delete;
+    FrameBufferTarget& operator=(const FrameBufferTarget&) = delete;
+    void     begin(uint8_t brightness) override;
+    uint16_t getWidth() const override { return _width; }
+    uint16_t getHeight() const override { return _height; }
+    uint16_t getRefreshRate() override { return 120; }
+
+    CRGB*    backBuffer() override { return _back; }
+    void     fillScreen(const CRGB& color) override;
+    void     fillRectangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, const CRGB& color) override;
+    void     drawString(int16_t x, int16_t y, const CRGB& color, RenderFont font, const char* text) override;
+    void     show() override;
+
+    void     startScroll(const char* text, int scrolls, const ScrollStyle& style) override;
+    void     stopScroll() override;
+    int      getScrollStatus() override;
+
+    const CRGB* frame() const { return _frame; }
+    uint32_t    getShows() const { return _shows; }
+    uint64_t    hash() const;                   // FNV-1a of frame()
+    bool        writePPM(const char* path) const;
+
+    static int  fontWidth(RenderFont font);
+    static int  fontHeight(RenderFont font);
+
+private:
+    uint16_t    _width;
+    uint16_t    _height;
+    CRGB*       _back;      // drawn into
+    CRGB*       _front;     // background as last shown
+    CRGB*       _frame;     // _front with the scrolling text on top
+    uint32_t    _shows;
+    char        _text[FRAME_BUFFER_TEXT_SIZE];
+    ScrollStyle _style;
+    int         _scrolls;
+    int64_t     _started;   // us
+
+    void     text(CRGB* buffer, int16_t x, int16_t y, const CRGB& color, RenderFont font, const char* text);
+    int64_t  passTime() const;  // us for the text to cross from style.left and leave
+    void     compose();
+};
+
+#endif // FRAME_BUFFER_TARGET_H_
@@ -0,0 +1,121 @@
+/**
+ * @file FrameScheduler.cpp
+ * @author Christoper B. Liebman
+ * @brief fixed rate frame deadlines, jitter and overrun counters, effect quality
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#include "FrameScheduler.h"
+#include <string.h>
+
+FrameScheduler::FrameScheduler(uint32_t period_us, uint32_t budget_us)
+: _period_us(period_us),
+  _budget_us(budget_us ? budget_us : period_us),
+  _deadline(0),
+  _started(0),
+  _elapsed_us(0),
+  _first(true)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void FrameScheduler::begin(uint32_t now)
+{
+    _deadline   = now;
+    _started    = now;
+    _elapsed_us = 0;
+    _first      = true;
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+uint32_t FrameScheduler::untilDeadline(uint32_t now) const
+{
+    int32_t left = (int32_t)(_deadline - now);
+    return left > 0 ? left : 0;
+}
+
+void FrameScheduler::frameStart(uint32_t now)
+{
+    int32_t jitter = (int32_t)(now - _deadline);
+    if (jitter < 0)
+    {
+        jitter = 0;     // woken early, treat as on time
+    }
+    _stats.last_jitter_us = jitter;
+    if ((uint32_t)jitter > _stats.max_jitter_us)
+    {
+        _stats.max_jitter_us = jitter;
+    }
+    _elapsed_us = _first ? _period_us : now - _started;
+    _first      = false;
+    _started    = now;
+}
+
+void FrameScheduler::frameEnd(uint32_t now)
+{
+    uint32_t took = now - _started;
+    _stats.frames++;
+    _stats.last_frame_us = took;
+    if (took > _stats.max_frame_us)
+    {
+        _stats.max_frame_us = took;
+    }
+    if (took > _budget_us)
+    {
+        _stats.overruns++;
+    }
+
+    // stay on phase, skipping any deadline already behind us, a frame that
+    // ends exactly on the next deadline is on time
+    _deadline += _period_us;
+    int32_t late = (int32_t)(now - _deadline);
+    if (late > 0)
+    {
+        uint32_t missed = (late - 1) / _period_us + 1;
+        _stats.skipped += missed;
+        _deadline      += missed * _period_us;
+    }
+}
+
+EffectGovernor::EffectGovernor(uint16_t min_quality)
+: _min_quality(min_quality),
+  _quality(EFFECT_QUALITY_FULL),
+  _reductions(0)
+{
+}
+
+void EffectGovernor::update(uint32_t frame_us, uint32_t budget_us)
+{
+    if (frame_us > budget_us)
+    {
+        uint16_t quality = _quality - _quality / 4;
+        _quality = quality < _min_quality ? _min_quality : quality;
+        _reductions++;
+    }
+    else if (frame_us < budget_us / 100 * EFFECT_HEADROOM_PCT && _quality < EFFECT_QUALITY_FULL)
+    {
+        uint16_t quality = _quality + EFFECT_QUALITY_STEP;
+        _quality = quality > EFFECT_QUALITY_FULL ? EFFECT_QUALITY_FULL : quality;
+    }
+}
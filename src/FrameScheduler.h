@@ -0,0 +1,102 @@
+/**
+ * @file FrameScheduler.h
+ * @author Christoper B. Liebman
+ * @brief fixed rate frame deadlines, jitter and overrun counters, effect quality
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef FRAME_SCHEDULER_H_
+#define FRAME_SCHEDULER_H_
+
+#include <stdint.h>
+
+#ifndef DISPLAY_FPS
+#define DISPLAY_FPS 30
+#endif
+
+#define EFFECT_QUALITY_FULL     256     // quality is a fraction of this
+#define EFFECT_QUALITY_MIN      16
+#define EFFECT_QUALITY_STEP     8       // added back per frame with headroom
+#define EFFECT_HEADROOM_PCT     60      // frames under this much of the budget have headroom
+
+struct FrameStats
+{
+    uint32_t frames;            // frames run
+    uint32_t overruns;          // frames that took longer than the budget
+    uint32_t skipped;           // deadlines missed completely
+    uint32_t last_jitter_us;    // start of the last frame past its deadline
+    uint32_t max_jitter_us;
+    uint32_t last_frame_us;     // time spent in the last frame
+    uint32_t max_frame_us;
+};
+
+/**
+ * Frame deadlines on a fixed period.  Like ButtonDebouncer it is a pure state
+ * machine fed with timestamps (micros) so it can be driven on the host.
+ * Deadlines stay on the original phase, a frame that runs past one or more
+ * later deadlines counts them as skipped instead of bunching frames up.
+ */
+class FrameScheduler
+{
+public:
+    FrameScheduler(uint32_t period_us = 1000000 / DISPLAY_FPS, uint32_t budget_us = 0);
+    void     begin(uint32_t now);
+    uint32_t untilDeadline(uint32_t now) const;  // 0 once the frame is due
+    void     frameStart(uint32_t now);
+    void     frameEnd(uint32_t now);
+    uint32_t elapsed() const { return _elapsed_us; }    // since the previous frame started
+    uint32_t getPeriod() const { return _period_us; }
+    uint32_t getBudget() const { return _budget_us; }
+    const FrameStats& stats() const { return _stats; }
+
+private:
+    uint32_t   _period_us;
+    uint32_t   _budget_us;
+    uint32_t   _deadline;
+    uint32_t   _started;
+    uint32_t   _elapsed_us;
+    bool       _first;
+    FrameStats _stats;
+};
+
+/**
+ * Effect density under a frame budget.  An overrun cuts the quality by a
+ * quarter at once, frames with headroom give it back a step at a time so it
+ * does not oscillate.  Only optional effects are scaled, never the score.
+ */
+class EffectGovernor
+{
+public:
+    EffectGovernor(uint16_t min_quality = EFFECT_QUALITY_MIN);
+    void     update(uint32_t frame_us, uint32_t budget_us);
+    uint16_t quality() const { return _quality; }
+    uint32_t reductions() const { return _reductions; }
+
+private:
+    uint16_t _min_quality;
+    uint16_t _quality;
+    uint32_t _reductions;   // times the quality was cut
+};
+
+#endif // FRAME_SCHEDULER_H_
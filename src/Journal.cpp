@@ -0,0 +1,187 @@
+/**
+ * @file Journal.cpp
+ * @author Christoper B. Liebman
+ * @brief append-only, crc framed score journal
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#include "Journal.h"
+#include <string.h>
+
+Journal::Journal(JournalStore& store, size_t compact_records)
+: _store(store),
+  _compact_records(compact_records),
+  _batch(),
+  _pending(0),
+  _records(0),
+  _dirty(false),
+  _seq(0),
+  _commits(0),
+  _compactions(0)
+{
+}
+
+uint32_t Journal::crc32(const uint8_t* data, size_t len)
+{
+    // nibble table, small enough for flash and fast enough for 20 byte records
+    static const uint32_t table[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+    };
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < len; ++i)
+    {
+        crc = table[(crc ^ data[i]) & 0x0f] ^ (crc >> 4);
+        crc = table[(crc ^ (data[i] >> 4)) & 0x0f] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+bool Journal::valid(const JournalRecord& record)
+{
+    return record.magic == MAGIC && record.version == VERSION &&
+           record.crc == crc32((const uint8_t*)&record, offsetof(JournalRecord, crc));
+}
+
+/**
+ * Scan the store for the newest valid record.  The scan stops at the first
+ * bad record (a commit torn by a reset), that tail is dropped on the next
+ * commit.  Returns false if there is nothing to restore.
+ */
+bool Journal::load(JournalRecord& last)
+{
+    size_t size  = _store.size();
+    bool   found = false;
+    _records = 0;
+    _dirty   = false;
+
+    JournalRecord chunk[JOURNAL_BATCH_SIZE];
+    size_t offset = 0;
+    while (offset < size && !_dirty)
+    {
+        size_t len   = _store.read(offset, (uint8_t*)chunk, sizeof(chunk));
+        size_t count = len / sizeof(JournalRecord);
+        if (count == 0)
+        {
+            _dirty = true;
+            break;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!valid(chunk[i]) || (found && chunk[i].seq != last.seq + 1))
+            {
+                _dirty = true;
+                break;
+            }
+            last  = chunk[i];
+            found = true;
+            ++_records;
+        }
+        offset += count * sizeof(JournalRecord);
+    }
+    _seq = found ? last.seq + 1 : 0;
+    return found;
+}
+
+// queue a record, commits on its own when the batch is full
+bool Journal::append(uint32_t score, uint32_t match)
+{
+    JournalRecord& record = _batch[_pending++];
+    record.magic   = MAGIC;
+    record.version = VERSION;
+    record.seq     = _seq++;
+    record.score   = score;
+    record.match   = match;
+    record.crc     = crc32((const uint8_t*)&record, offsetof(JournalRecord, crc));
+    if (_pending == JOURNAL_BATCH_SIZE)
+    {
+        return commit();
+    }
+    return true;
+}
+
+bool Journal::commit()
+{
+    if (_pending == 0)
+    {
+        return true;
+    }
+
+    // a copy, a failed commit keeps it as the only pending record
+    JournalRecord last = _batch[_pending - 1];
+    bool ok;
+    if (_dirty || _records + _pending > _compact_records)
+    {
+        ok = compact(last);
+    }
+    else
+    {
+        ok = _store.append((const uint8_t*)_batch, _pending * sizeof(JournalRecord)) && _store.sync();
+        if (ok)
+        {
+            _records += _pending;
+        }
+        else
+        {
+            // a torn append may leave a partial record, rewrite a clean snapshot next time
+            _dirty = true;
+        }
+    }
+    ++_commits;
+    _pending = 0;
+    if (!ok)
+    {
+        // the newest state is not durable yet, keep it for the retry
+        _batch[_pending++] = last;
+    }
+    return ok;
+}
+
+// replace the store with a single snapshot record, seq restarts at 0
+bool Journal::compact(const JournalRecord& last)
+{
+    JournalRecord snapshot = last;
+    snapshot.seq = 0;
+    snapshot.crc = crc32((const uint8_t*)&snapshot, offsetof(JournalRecord, crc));
+    _seq = 1;
+    ++_compactions;
+    if (!_store.rewrite((const uint8_t*)&snapshot, sizeof(snapshot)))
+    {
+        _dirty = true;
+        return false;
+    }
+    _records = 1;
+    _dirty   = false;
+    return true;
+}
+
+bool Journal::clear()
+{
+    _pending = 0;
+    _records = 0;
+    _seq     = 0;
+    _dirty   = false;
+    return _store.rewrite(nullptr, 0);
+}
@@ -0,0 +1,111 @@
+/**
+ * @file Journal.h
+ * @author Christoper B. Liebman
+ * @brief append-only, crc framed score journal
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef JOURNAL_H_
+#define JOURNAL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef JOURNAL_BATCH_SIZE
+#define JOURNAL_BATCH_SIZE 16           // records per group commit
+#endif
+
+#ifndef JOURNAL_COMPACT_RECORDS
+#define JOURNAL_COMPACT_RECORDS 512     // rewrite as a single snapshot past this many
+#endif
+
+/**
+ * One journal record.  Every record carries the whole packed score and
+ * match so the newest valid record is the state to restore and anything
+ * older can be compacted away.
+ */
+typedef struct journal_record {
+    uint16_t magic;
+    uint16_t version;
+    uint32_t seq;
+    uint32_t score;
+    uint32_t match;
+    uint32_t crc;       // crc32 of everything above
+} JournalRecord;
+
+/**
+ * Where the records live.  append() adds to the end, sync() makes what was
+ * appended durable and rewrite() atomically replaces everything.
+ */
+class JournalStore
+{
+public:
+    virtual ~JournalStore() {}
+    virtual size_t size() = 0;
+    virtual size_t read(size_t offset, uint8_t* data, size_t len) = 0;
+    virtual bool   append(const uint8_t* data, size_t len) = 0;
+    virtual bool   sync() = 0;
+    virtual bool   rewrite(const uint8_t* data, size_t len) = 0;
+};
+
+/**
+ * Batches records in RAM and writes each batch with a single append/sync
+ * (group commit).  Once the store holds JOURNAL_COMPACT_RECORDS records it
+ * is rewritten with just the newest one, which bounds both its size and the
+ * flash wear.  A failed commit keeps the newest record pending and the
+ * next commit rewrites it as a snapshot.  No hardware dependencies, single
+ * threaded.
+ */
+class Journal
+{
+public:
+    explicit Journal(JournalStore& store, size_t compact_records = JOURNAL_COMPACT_RECORDS);
+    bool   load(JournalRecord& last);
+    bool   append(uint32_t score, uint32_t match);
+    bool   commit();
+    bool   clear();
+    size_t pending() const { return _pending; }
+    size_t records() const { return _records; }
+    uint32_t commits() const { return _commits; }
+    uint32_t compactions() const { return _compactions; }
+
+    static const uint16_t MAGIC   = 0x5342;   // "SB"
+    static const uint16_t VERSION = 1;
+    static uint32_t crc32(const uint8_t* data, size_t len);
+    static bool     valid(const JournalRecord& record);
+
+private:
+    JournalStore& _store;
+    size_t        _compact_records;
+    JournalRecord _batch[JOURNAL_BATCH_SIZE];
+    size_t        _pending;         // records in _batch
+    size_t        _records;         // valid records in the store
+    bool          _dirty;           // store has a torn tail, rewrite on next commit
+    uint32_t      _seq;
+    uint32_t      _commits;
+    uint32_t      _compactions;
+    bool compact(const JournalRecord& last);
+};
+
+#endif // JOURNAL_H_
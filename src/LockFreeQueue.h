@@ -0,0 +1,158 @@
+/**
+ * @file LockFreeQueue.h
+ * @author Christoper B. Liebman
+ * @brief bounded lock-free queues
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef LOCK_FREE_QUEUE_H_
+#define LOCK_FREE_QUEUE_H_
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Single producer / single consumer ring.  The producer may be an ISR, push()
+ * and pop() never block or allocate.  SIZE must be a power of 2.
+ */
+template<class T, size_t SIZE>
+class SpscQueue
+{
+    static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of 2");
+
+public:
+    SpscQueue() : _head(0), _tail(0) {}
+
+    bool push(const T& item)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) >= SIZE)
+        {
+            return false; // full
+        }
+        _items[tail & (SIZE - 1)] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+        {
+            return false; // empty
+        }
+        item = _items[head & (SIZE - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    T                   _items[SIZE];
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+};
+
+/**
+ * Bounded multi producer / single consumer queue.  Each slot carries a
+ * sequence number so producers claim a slot with a single compare-exchange
+ * and the consumer only sees a slot once its producer has finished writing.
+ * SIZE must be a power of 2.
+ */
+template<class T, size_t SIZE>
+class MpscQueue
+{
+    static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of 2");
+
+public:
+    MpscQueue() : _head(0), _tail(0)
+    {
+        for (size_t i = 0; i < SIZE; ++i)
+        {
+            _slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const T& item)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true)
+        {
+            slot = &_slots[tail & (SIZE - 1)];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)tail;
+            if (diff == 0)
+            {
+                if (_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                tail = _tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->item = item;
+        slot->seq.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        Slot* slot = &_slots[head & (SIZE - 1)];
+        if (slot->seq.load(std::memory_order_acquire) != head + 1)
+        {
+            return false; // empty (or the producer is still writing)
+        }
+        item = slot->item;
+        slot->seq.store(head + SIZE, std::memory_order_release);
+        _head.store(head + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> seq;
+        T                   item;
+    };
+    Slot                _slots[SIZE];
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+};
+
+#endif // LOCK_FREE_QUEUE_H_
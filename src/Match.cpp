@@ -0,0 +1,170 @@
+/**
+ * @file Match.cpp
+ * @author Christoper B. Liebman
+ * @brief games won and game progress for a best-of-N match
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#include "Match.h"
+#include "Log.h"
+
+static const char* TAG = "Match";
+
+bool Match::State::isMatchOver() const
+{
+    int games = getGamesToWin();
+    return getGamesWon(Score::RED) >= games || getGamesWon(Score::BLUE) >= games;
+}
+
+bool Match::State::isDecidingGame() const
+{
+    int games = getGamesToWin() - 1;
+    return getGamesWon(Score::RED) == games && getGamesWon(Score::BLUE) == games;
+}
+
+Match::State Match::State::withGamesWon(Score::Team team, int games) const
+{
+    int shift = team * GAMES_BITS;
+    return State((_packed & ~(GAMES_MASK << shift)) | ((games & GAMES_MASK) << shift));
+}
+
+Match::State Match::State::withGame(int game) const
+{
+    return State((_packed & ~(GAMES_MASK << GAME_SHIFT)) | ((game & GAMES_MASK) << GAME_SHIFT));
+}
+
+Match::State Match::State::withBestOf(int best_of) const
+{
+    return State((_packed & ~(GAMES_MASK << BEST_OF_SHIFT)) | ((best_of & GAMES_MASK) << BEST_OF_SHIFT));
+}
+
+Match::State Match::State::withInterval(bool interval) const
+{
+    return State((_packed & ~(1 << INTERVAL_SHIFT)) | ((uint32_t)interval << INTERVAL_SHIFT));
+}
+
+Match::State Match::State::withEndSwapped(bool swapped) const
+{
+    return State((_packed & ~(1 << END_SWAPPED_SHIFT)) | ((uint32_t)swapped << END_SWAPPED_SHIFT));
+}
+
+Match::State Match::State::withStartSwapped(bool swapped) const
+{
+    return State((_packed & ~(1 << START_SWAPPED_SHIFT)) | ((uint32_t)swapped << START_SWAPPED_SHIFT));
+}
+
+Match::Match(int best_of)
+: _state(State().withBestOf(best_of)._packed)
+{
+}
+
+Match::State Match::snapshot() const
+{
+    return State(_state.load(std::memory_order_acquire));
+}
+
+void Match::publish(State state)
+{
+    // single writer (the App task) so a plain store is enough
+    _state.store(state._packed, std::memory_order_release);
+}
+
+/**
+ * Fold one score change into the match, returns true when the teams should
+ * change ends now (the interval of the deciding game).
+ */
+bool Match::point(const Score::State& before, const Score::State& after)
+{
+    State match     = snapshot();
+    bool  was_over  = before.isGameOver();
+    bool  is_over   = after.isGameOver();
+    bool  swap_ends = false;
+
+    if (!was_over && is_over)
+    {
+        Score::Team winner = after.getLeader();
+        match = match.withGamesWon(winner, match.getGamesWon(winner) + 1);
+    }
+    else if (was_over && !is_over)
+    {
+        // the winning point was taken back
+        Score::Team winner = before.getLeader();
+        match = match.withGamesWon(winner, match.getGamesWon(winner) - 1);
+    }
+
+    // the interval is when the leading score reaches half the limit (11 of 21)
+    int interval = (after.getLimit() + 1) / 2;
+    int leading  = after.getTeamScore(after.getLeader());
+    if (!is_over && !match.isInterval() && leading >= interval)
+    {
+        dlog.info(TAG, "point: interval in game %d at %d", match.getGame() + 1, leading);
+        match = match.withInterval(true);
+        if (match.isDecidingGame() && !match.isEndSwapped())
+        {
+            match = match.withEndSwapped(true);
+            swap_ends = true;
+        }
+    }
+
+    publish(match);
+    return swap_ends;
+}
+
+/**
+ * Record the ends the current game starts with, the referee may swap them
+ * before the first point.  Following games alternate from there.
+ */
+void Match::startEnds(bool swapped)
+{
+    publish(snapshot().withStartSwapped(swapped));
+}
+
+void Match::nextGame()
+{
+    State match = snapshot();
+    dlog.info(TAG, "nextGame: game %d games: %d-%d", match.getGame() + 2,
+              match.getGamesWon(Score::RED), match.getGamesWon(Score::BLUE));
+    // teams change ends every game
+    publish(match.withGame(match.getGame() + 1)
+                .withInterval(false)
+                .withEndSwapped(false)
+                .withStartSwapped(!match.isStartSwapped()));
+}
+
+void Match::restartGame()
+{
+    publish(snapshot().withInterval(false).withEndSwapped(false));
+}
+
+void Match::restore(const State& state)
+{
+    publish(state);
+}
+
+void Match::reset()
+{
+    dlog.info(TAG, "reset()");
+    publish(State().withBestOf(snapshot().getBestOf()));
+}
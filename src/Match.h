@@ -0,0 +1,111 @@
+/**
+ * @file Match.h
+ * @author Christoper B. Liebman
+ * @brief games won and game progress for a best-of-N match
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef MATCH_H_
+#define MATCH_H_
+
+#include <stdint.h>
+#include <atomic>
+#include "Score.h"
+
+#ifndef DEFAULT_MATCH_BEST_OF
+#define DEFAULT_MATCH_BEST_OF 3
+#endif
+
+/**
+ * Tracks a best-of-N match.  Only the App task writes it, each point is
+ * folded in from the score before and after so nothing is recomputed from
+ * history.  Other tasks read it through snapshot() like Score.
+ */
+class Match
+{
+public:
+    /**
+     * Immutable copy of the match packed into a single word.
+     *
+     *  bits  0-3  RED games won
+     *  bits  4-7  BLUE games won
+     *  bits  8-11 game index (0 based)
+     *  bits 12-15 best of
+     *  bit  16    mid-game interval reached this game
+     *  bit  17    ends changed in the deciding game
+     */
+    class State
+    {
+    public:
+        State() : _packed(0) {}
+        int  getGamesWon(Score::Team team) const { return (_packed >> (team * GAMES_BITS)) & GAMES_MASK; }
+        int  getGame() const { return (_packed >> GAME_SHIFT) & GAMES_MASK; }
+        int  getBestOf() const { return (_packed >> BEST_OF_SHIFT) & GAMES_MASK; }
+        int  getGamesToWin() const { return getBestOf() / 2 + 1; }
+        bool isInterval() const { return (_packed >> INTERVAL_SHIFT) & 1; }
+        bool isEndSwapped() const { return (_packed >> END_SWAPPED_SHIFT) & 1; }
+        bool isStartSwapped() const { return (_packed >> START_SWAPPED_SHIFT) & 1; }
+        bool isMatchOver() const;
+        bool isDecidingGame() const;
+        Score::Team getLeader() const { return getGamesWon(Score::BLUE) > getGamesWon(Score::RED) ? Score::BLUE : Score::RED; }
+        bool operator==(const State& other) const { return _packed == other._packed; }
+        bool operator!=(const State& other) const { return _packed != other._packed; }
+        // raw word for persisting, fromPacked() is the inverse
+        uint32_t getPacked() const { return _packed; }
+        static State fromPacked(uint32_t packed) { return State(packed); }
+
+    private:
+        friend class Match;
+        static const int GAMES_BITS          = 4;
+        static const int GAMES_MASK          = (1 << GAMES_BITS) - 1;
+        static const int GAME_SHIFT          = 8;
+        static const int BEST_OF_SHIFT       = 12;
+        static const int INTERVAL_SHIFT      = 16;
+        static const int END_SWAPPED_SHIFT   = 17;
+        static const int START_SWAPPED_SHIFT = 18;
+        explicit State(uint32_t packed) : _packed(packed) {}
+        State withGamesWon(Score::Team team, int games) const;
+        State withGame(int game) const;
+        State withBestOf(int best_of) const;
+        State withInterval(bool interval) const;
+        State withEndSwapped(bool swapped) const;
+        State withStartSwapped(bool swapped) const;
+        uint32_t _packed;
+    };
+
+    Match(int best_of = DEFAULT_MATCH_BEST_OF);
+    State snapshot() const;
+    bool point(const Score::State& before, const Score::State& after);
+    void startEnds(bool swapped);
+    void nextGame();
+    void restartGame();
+    void reset();
+    void restore(const State& state);
+
+private:
+    std::atomic<uint32_t> _state;
+    void publish(State state);
+};
+
+#endif // MATCH_H_
@@ -0,0 +1,128 @@
+/**
+ * @file OverlayQueue.cpp
+ * @author Christoper B. Liebman
+ * @brief timed, prioritized text overlays for the Display
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#include "OverlayQueue.h"
+#include <string.h>
+
+OverlayQueue::OverlayQueue()
+: _order(0)
+{
+    clear();
+}
+
+void OverlayQueue::clear()
+{
+    memset(_slots, 0, sizeof(_slots));
+}
+
+void OverlayQueue::clearUntimed()
+{
+    for (int i = 0; i < OVERLAY_SLOTS; ++i)
+    {
+        if (_slots[i].overlay.duration_ms == 0)
+        {
+            _slots[i].used = false;
+        }
+    }
+}
+
+bool OverlayQueue::add(const Overlay& overlay, uint32_t now)
+{
+    // this replaces any open ended overlay it would cover
+    for (int i = 0; i < OVERLAY_SLOTS; ++i)
+    {
+        if (_slots[i].used && _slots[i].overlay.duration_ms == 0 && _slots[i].overlay.priority <= overlay.priority)
+        {
+            _slots[i].used = false;
+        }
+    }
+
+    Slot* slot = nullptr;
+    for (int i = 0; i < OVERLAY_SLOTS; ++i)
+    {
+        if (!_slots[i].used)
+        {
+            slot = &_slots[i];
+            break;
+        }
+        if (slot == nullptr ||
+            _slots[i].overlay.priority < slot->overlay.priority ||
+            (_slots[i].overlay.priority == slot->overlay.priority && _slots[i].order < slot->order))
+        {
+            slot = &_slots[i];
+        }
+    }
+    if (slot->used && slot->overlay.priority > overlay.priority)
+    {
+        // full of more important overlays, never push one of them out
+        return false;
+    }
+    slot->overlay = overlay;
+    slot->overlay.text[sizeof(slot->overlay.text) - 1] = '\0';
+    slot->used  = true;
+    slot->shown = false;
+    slot->since = now;
+    slot->order = _order++;
+    return true;
+}
+
+const Overlay* OverlayQueue::update(uint32_t now)
+{
+    Slot* best = nullptr;
+    for (int i = 0; i < OVERLAY_SLOTS; ++i)
+    {
+        Slot& slot = _slots[i];
+        if (!slot.used)
+        {
+            continue;
+        }
+        uint32_t age = now - slot.since;
+        if (slot.shown ? (slot.overlay.duration_ms && age >= slot.overlay.duration_ms)
+                       : (slot.overlay.expire_ms && age >= slot.overlay.expire_ms))
+        {
+            slot.used = false;
+            continue;
+        }
+        if (best == nullptr ||
+            slot.overlay.priority > best->overlay.priority ||
+            (slot.overlay.priority == best->overlay.priority && slot.order > best->order))
+        {
+            best = &slot;
+        }
+    }
+    if (best == nullptr)
+    {
+        return nullptr;
+    }
+    if (!best->shown)
+    {
+        best->shown = true;
+        best->since = now;
+    }
+    return &best->overlay;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file OverlayQueue.h
+ * @author Christoper B. Liebman
+ * @brief timed, prioritized text overlays for the Display
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef OVERLAY_QUEUE_H_
+#define OVERLAY_QUEUE_H_
+
+#include <stdint.h>
+
+#ifndef DISPLAY_MESSAGE_SIZE
+#define DISPLAY_MESSAGE_SIZE    48
+#endif
+#define OVERLAY_SLOTS           4
+
+enum OverlayPriority : uint8_t
+{
+    OVERLAY_PRIORITY_INFO   = 0,    // nice to see
+    OVERLAY_PRIORITY_STATUS = 1,    // boot and network progress
+    OVERLAY_PRIORITY_ALERT  = 2,    // needs the user, the WiFi portal
+};
+
+typedef struct overlay {
+    char     text[DISPLAY_MESSAGE_SIZE];
+    uint32_t duration_ms;   // shown this long once it is up, 0 until replaced or cleared
+    uint32_t expire_ms;     // dropped if not up within this long of posting, 0 never
+    uint8_t  priority;      // OverlayPriority
+} Overlay;
+
+/**
+ * The overlays waiting to be shown, owned by the Display task.  Like
+ * FrameScheduler it is a pure state machine fed with millis().  The highest
+ * priority overlay is up, the newest wins a tie.  Once up its duration runs
+ * even while a higher priority one covers it, an overlay that never made it
+ * up by its expiry is dropped.  When all slots are full the lowest priority,
+ * oldest overlay makes room unless it outranks the new one, then the new
+ * one is dropped and add() returns false.
+ */
+class OverlayQueue
+{
+public:
+    OverlayQueue();
+    bool           add(const Overlay& overlay, uint32_t now);
+    const Overlay* update(uint32_t now);    // the overlay to show, nullptr for none
+    void           clear();
+    void           clearUntimed();          // drop every overlay with no duration
+
+private:
+    struct Slot
+    {
+        Overlay  overlay;
+        bool     used;
+        bool     shown;
+        uint32_t since;     // posted, then shown
+        uint32_t order;     // post order for ties
+    };
+    Slot     _slots[OVERLAY_SLOTS];
+    uint32_t _order;
+};
+
+#endif // OVERLAY_QUEUE_H_
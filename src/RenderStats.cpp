@@ -0,0 +1,229 @@
+/**
+ * @file RenderStats.cpp
+ * @author Christoper B. Liebman
+ * @brief render and refresh telemetry
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#include "RenderStats.h"
+
+#define RENDER_STATS_SUB    (1 << RENDER_STATS_SUB_BITS)
+
+RenderHistogram::RenderHistogram()
+: _count(0),
+  _max(0)
+{
+    for (size_t i = 0; i < RENDER_STATS_BUCKETS; ++i)
+    {
+        _counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Below RENDER_STATS_SUB each value has a bucket, above that every power of
+ * 2 is split in RENDER_STATS_SUB buckets on the bits under the top one.
+ */
+uint8_t RenderHistogram::bucket(uint32_t us)
+{
+    if (us < RENDER_STATS_SUB)
+    {
+        return us;
+    }
+    uint32_t top    = 31 - __builtin_clz(us);
+    uint32_t bucket = ((top - RENDER_STATS_SUB_BITS + 1) << RENDER_STATS_SUB_BITS) +
+                      ((us >> (top - RENDER_STATS_SUB_BITS)) & (RENDER_STATS_SUB - 1));
+    return bucket < RENDER_STATS_BUCKETS ? bucket : RENDER_STATS_BUCKETS - 1;
+}
+
+uint32_t RenderHistogram::bucketLimit(uint8_t bucket)
+{
+    if (bucket < RENDER_STATS_SUB)
+    {
+        return bucket;
+    }
+    uint32_t shift = (bucket >> RENDER_STATS_SUB_BITS) - 1;
+    uint32_t lower = (RENDER_STATS_SUB + (bucket & (RENDER_STATS_SUB - 1))) << shift;
+    return lower + (1 << shift) - 1;
+}
+
+void RenderHistogram::record(uint32_t us)
+{
+    _counts[bucket(us)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    if (us > max())
+    {
+        _max.store(us, std::memory_order_relaxed);
+    }
+}
+
+uint32_t RenderHistogram::percentile(uint8_t pct) const
+{
+    uint32_t total = count();
+    if (total == 0)
+    {
+        return 0;
+    }
+    uint32_t rank = ((uint64_t)total * pct + 99) / 100;
+    uint32_t seen = 0;
+    for (size_t i = 0; i < RENDER_STATS_BUCKETS; ++i)
+    {
+        seen += _counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            uint32_t limit = bucketLimit(i);
+            return limit < max() ? limit : max();
+        }
+    }
+    return max();
+}
+
+void RenderHistogram::writeJson(Print& out) const
+{
+    out.printf("{\"count\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}",
+               count(), percentile(50), percentile(90), percentile(99), max());
+}
+
+RenderStats::RenderStats()
+: _render(),
+  _frame(),
+  _latency(),
+  _frames(0),
+  _dropped(0),
+  _overruns(0),
+  _posts(0),
+  _coalesced(0),
+  _waiting(0),
+  _waiting_hwm(0),
+  _overlays_hwm(0),
+  _samples(0),
+  _overlay(false),
+  _sample_ms(0),
+  _sample_frames(0)
+{
+    for (size_t i = 0; i < RENDER_STATS_HISTORY; ++i)
+    {
+        _history[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+RenderStats& RenderStats::getInstance()
+{
+    static RenderStats instance;
+    return instance;
+}
+
+void RenderStats::posted(bool coalesced)
+{
+    _posts.fetch_add(1, std::memory_order_relaxed);
+    _waiting.fetch_add(1, std::memory_order_relaxed);
+    if (coalesced)
+    {
+        _coalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RenderStats::taken(uint32_t overlays)
+{
+    uint32_t waiting = _waiting.exchange(0, std::memory_order_relaxed);
+    if (waiting > _waiting_hwm.load(std::memory_order_relaxed))
+    {
+        _waiting_hwm.store(waiting, std::memory_order_relaxed);
+    }
+    if (overlays > _overlays_hwm.load(std::memory_order_relaxed))
+    {
+        _overlays_hwm.store(overlays, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * After each frame is shown.  Every RENDER_STATS_SAMPLE_MS the frames shown
+ * since the last sample become a frames per second sample in the ring.
+ */
+void RenderStats::frame(const FrameStats& frames, uint32_t now_ms, uint16_t refresh_hz)
+{
+    _frame.record(frames.last_frame_us);
+    _frames.store(frames.frames, std::memory_order_relaxed);
+    _dropped.store(frames.skipped, std::memory_order_relaxed);
+    _overruns.store(frames.overruns, std::memory_order_relaxed);
+
+    uint32_t elapsed = now_ms - _sample_ms;
+    if (_sample_frames == 0 || frames.frames < _sample_frames)
+    {
+        // first frame, or the FrameScheduler started over
+        _sample_ms     = now_ms;
+        _sample_frames = frames.frames;
+    }
+    else if (elapsed >= RENDER_STATS_SAMPLE_MS)
+    {
+        uint32_t fps     = ((frames.frames - _sample_frames) * 1000 + elapsed / 2) / elapsed;
+        uint32_t samples = _samples.load(std::memory_order_relaxed);
+        _history[samples % RENDER_STATS_HISTORY].store((fps << 16) | refresh_hz, std::memory_order_relaxed);
+        _samples.store(samples + 1, std::memory_order_release);
+        _sample_ms     = now_ms;
+        _sample_frames = frames.frames;
+    }
+}
+
+uint16_t RenderStats::fps() const
+{
+    uint32_t samples = _samples.load(std::memory_order_acquire);
+    return samples ? _history[(samples - 1) % RENDER_STATS_HISTORY].load(std::memory_order_relaxed) >> 16 : 0;
+}
+
+uint16_t RenderStats::refreshRate() const
+{
+    uint32_t samples = _samples.load(std::memory_order_acquire);
+    return samples ? _history[(samples - 1) % RENDER_STATS_HISTORY].load(std::memory_order_relaxed) & 0xffff : 0;
+}
+
+void RenderStats::writeJson(Print& out) const
+{
+    out.printf("{\"frames\":%u,\"dropped\":%u,\"overruns\":%u,\"posts\":%u,\"coalesced\":%u,"
+               "\"waiting_hwm\":%u,\"overlays_hwm\":%u,\"overlay\":%s,",
+               frames(), dropped(), overruns(), _posts.load(std::memory_order_relaxed), coalesced(),
+               _waiting_hwm.load(std::memory_order_relaxed), _overlays_hwm.load(std::memory_order_relaxed),
+               overlay() ? "true" : "false");
+    out.print("\"render_us\":");
+    _render.writeJson(out);
+    out.print(",\"frame_us\":");
+    _frame.writeJson(out);
+    out.print(",\"latency_us\":");
+    _latency.writeJson(out);
+
+    // oldest first
+    uint32_t samples = _samples.load(std::memory_order_acquire);
+    uint32_t first   = samples < RENDER_STATS_HISTORY ? 0 : samples - RENDER_STATS_HISTORY;
+    out.printf(",\"sample_ms\":%u,\"fps\":[", RENDER_STATS_SAMPLE_MS);
+    for (uint32_t i = first; i < samples; ++i)
+    {
+        out.printf("%s%u", i == first ? "" : ",", _history[i % RENDER_STATS_HISTORY].load(std::memory_order_relaxed) >> 16);
+    }
+    out.print("],\"refresh_hz\":[");
+    for (uint32_t i = first; i < samples; ++i)
+    {
+        out.printf("%s%u", i == first ? "" : ",", _history[i % RENDER_STATS_HISTORY].load(std::memory_order_relaxed) & 0xffff);
+    }
+    out.print("]}");
+}
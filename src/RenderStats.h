@@ -0,0 +1,129 @@
+/**
+ * @file RenderStats.h
+ * @author Christoper B. Liebman
+ * @brief render and refresh telemetry
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#ifndef RENDER_STATS_H_
+#define RENDER_STATS_H_
+
+#include <Arduino.h>
+#include <atomic>
+#include "FrameScheduler.h"
+
+#define RENDER_STATS_SUB_BITS   2       // histogram buckets per power of 2 is 1 << this
+#ifndef RENDER_STATS_BUCKETS
+#define RENDER_STATS_BUCKETS    64      // covers up to 131 ms, slower lands in the last
+#endif
+#ifndef RENDER_STATS_HISTORY
+#define RENDER_STATS_HISTORY    60      // refresh samples kept
+#endif
+#ifndef RENDER_STATS_SAMPLE_MS
+#define RENDER_STATS_SAMPLE_MS  1000    // one refresh sample per
+#endif
+
+/**
+ * Times in us bucketed log-linear, within 25% up to the last bucket.
+ * One writer, readers on any task see relaxed counters that may be a
+ * record apart from each other but are never torn.
+ */
+class RenderHistogram
+{
+public:
+    RenderHistogram();
+    void     record(uint32_t us);
+    uint32_t count() const { return _count.load(std::memory_order_relaxed); }
+    uint32_t max() const { return _max.load(std::memory_order_relaxed); }
+    uint32_t percentile(uint8_t pct) const;    // the top of the bucket holding it
+    void     writeJson(Print& out) const;
+    static uint8_t  bucket(uint32_t us);
+    static uint32_t bucketLimit(uint8_t bucket);   // largest us in the bucket
+
+private:
+    std::atomic<uint32_t> _counts[RENDER_STATS_BUCKETS];
+    std::atomic<uint32_t> _count;
+    std::atomic<uint32_t> _max;
+};
+
+/**
+ * Render and refresh telemetry from the Display task: render and frame time
+ * percentiles, frames dropped on missed deadlines, commands coalesced into
+ * one pending bit, the most commands and overlays waiting for the task at
+ * once, the time from App::changeNotify() to the frame going to the panel,
+ * and frames per second sampled over the last minute next to the panel's
+ * refresh rate.  Everything is atomic so the web server and the panel read
+ * it without a lock.  The overlay flag puts a compact copy on the panel,
+ * see Display::drawStats().
+ */
+class RenderStats
+{
+public:
+    static RenderStats& getInstance();
+
+    // any task or ISR
+    void posted(bool coalesced);
+    void setOverlay(bool on) { _overlay.store(on, std::memory_order_relaxed); }
+    void toggleOverlay() { _overlay.store(!overlay(), std::memory_order_relaxed); }
+
+    // the Display task
+    void taken(uint32_t overlays);
+    void rendered(uint32_t us) { _render.record(us); }
+    void changeShown(uint32_t us) { _latency.record(us); }
+    void frame(const FrameStats& frames, uint32_t now_ms, uint16_t refresh_hz);
+
+    bool overlay() const { return _overlay.load(std::memory_order_relaxed); }
+    const RenderHistogram& render() const { return _render; }
+    const RenderHistogram& frameTime() const { return _frame; }
+    const RenderHistogram& latency() const { return _latency; }
+    uint32_t frames() const { return _frames.load(std::memory_order_relaxed); }
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+    uint32_t overruns() const { return _overruns.load(std::memory_order_relaxed); }
+    uint32_t coalesced() const { return _coalesced.load(std::memory_order_relaxed); }
+    uint16_t fps() const;           // in the last sample
+    uint16_t refreshRate() const;   // panel, in the last sample
+    void     writeJson(Print& out) const;
+
+private:
+    RenderStats();
+    RenderHistogram       _render;      // doRender()
+    RenderHistogram       _frame;       // render, animate, overlays and show
+    RenderHistogram       _latency;     // changeNotify() to show()
+    std::atomic<uint32_t> _frames;
+    std::atomic<uint32_t> _dropped;     // deadlines missed, see FrameScheduler
+    std::atomic<uint32_t> _overruns;
+    std::atomic<uint32_t> _posts;
+    std::atomic<uint32_t> _coalesced;   // posts whose commands were all pending already
+    std::atomic<uint32_t> _waiting;     // posts since the task last took them
+    std::atomic<uint32_t> _waiting_hwm;
+    std::atomic<uint32_t> _overlays_hwm;
+    std::atomic<uint32_t> _history[RENDER_STATS_HISTORY];  // fps << 16 | refresh_hz
+    std::atomic<uint32_t> _samples;
+    std::atomic<bool>     _overlay;
+    uint32_t              _sample_ms;       // the Display task's own
+    uint32_t              _sample_frames;
+};
+
+#endif // RENDER_STATS_H_
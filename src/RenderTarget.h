@@ -0,0 +1,86 @@
+/**
+ * @file RenderTarget.h
+ * @author Christoper B. Liebman
+ * @brief where the Display draws, the panel or memory
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#ifndef RENDER_TARGET_H_
+#define RENDER_TARGET_H_
+
+#include <stdint.h>
+#include <FastLED.h>
+
+// the SmartMatrix fonts the Display uses for text
+enum RenderFont : uint8_t
+{
+    RENDER_FONT_3X5,
+    RENDER_FONT_5X7,
+    RENDER_FONT_6X10,
+    RENDER_FONT_8X13,
+    RENDER_FONT_GOHU11,
+    RENDER_FONT_GOHU11B,
+};
+
+// how scrolling text looks and where it starts, it always wraps forward
+struct ScrollStyle
+{
+    CRGB       color;
+    uint8_t    speed;   // pixels per second
+    RenderFont font;
+    int16_t    top;     // offset from the top of the panel
+    int16_t    left;    // where the text starts, the panel width to come in from the right
+};
+
+/**
+ * Two layers like the SmartMatrix panel: a 24 bit background that is drawn
+ * in place through backBuffer() and kept across show(), and one line of
+ * scrolling text on top of it that the target moves by itself.
+ * SmartMatrixTarget drives the panel, FrameBufferTarget composes both
+ * layers in memory so frames can be checked and timed on the host.
+ */
+class RenderTarget
+{
+public:
+    virtual ~RenderTarget() {}
+    virtual void     begin(uint8_t brightness) = 0;
+    virtual uint16_t getWidth() const = 0;
+    virtual uint16_t getHeight() const = 0;
+    virtual uint16_t getRefreshRate() = 0;
+
+    // background layer, row major, getWidth() pixels per row
+    virtual CRGB*    backBuffer() = 0;
+    virtual void     fillScreen(const CRGB& color) = 0;
+    virtual void     fillRectangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, const CRGB& color) = 0;   // inclusive
+    virtual void     drawString(int16_t x, int16_t y, const CRGB& color, RenderFont font, const char* text) = 0;
+    virtual void     show() = 0;
+
+    // scrolling layer
+    virtual void     startScroll(const char* text, int scrolls, const ScrollStyle& style) = 0;   // -1 forever
+    virtual void     stopScroll() = 0;
+    virtual int      getScrollStatus() = 0;     // scrolls left, -1 forever, 0 done
+};
+
+#endif // RENDER_TARGET_H_
@@ -0,0 +1,310 @@
+/**
+ * @file Scene.h
+ * @author Christoper B. Liebman
+ * @brief retained scene of the score panel with diffed redraw
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef SCENE_H_
+#define SCENE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "DigitAtlas.h"
+
+#define SCENE_MAX_NODES  8
+#define SCENE_BOX_WIDTH  2      // outline thickness of a BOX node
+
+/**
+ * One retained drawing primitive.  A RECT is a solid fill, DIGITS are two
+ * atlas digits with the cursor at (x, y) on the baseline, a BOX is an
+ * outline of SCENE_BOX_WIDTH pixels with a transparent inside.
+ */
+struct SceneNode
+{
+    enum Kind : uint8_t
+    {
+        NONE = 0,
+        RECT,
+        DIGITS,
+        BOX,
+    };
+
+    Kind     kind;
+    uint8_t  value;     // DIGITS 00-99
+    int16_t  x;
+    int16_t  y;
+    int16_t  width;     // RECT and BOX, DIGITS size comes from the atlas
+    int16_t  height;
+    uint32_t color;     // 0xRRGGBB
+
+    bool sameShape(const SceneNode& other) const
+    {
+        return kind == other.kind && x == other.x && y == other.y &&
+               width == other.width && height == other.height;
+    }
+
+    bool operator==(const SceneNode& other) const
+    {
+        return sameShape(other) && value == other.value && color == other.color;
+    }
+    bool operator!=(const SceneNode& other) const { return !(*this == other); }
+};
+
+struct SceneRect
+{
+    int16_t x0, y0, x1, y1;     // [x0, x1) x [y0, y1)
+
+    bool empty() const { return x0 >= x1 || y0 >= y1; }
+    bool contains(const SceneRect& r) const { return r.x0 >= x0 && r.y0 >= y0 && r.x1 <= x1 && r.y1 <= y1; }
+    SceneRect intersect(const SceneRect& r) const
+    {
+        SceneRect i = { x0 > r.x0 ? x0 : r.x0, y0 > r.y0 ? y0 : r.y0,
+                        x1 < r.x1 ? x1 : r.x1, y1 < r.y1 ? y1 : r.y1 };
+        return i;
+    }
+};
+
+/**
+ * Retained description of what the background layer shows, one node per
+ * slot with the slot index as the z order (higher draws on top).  paint()
+ * draws everything, update() diffs against the scene currently on the panel
+ * and repaints only the damaged rectangles, so a frame costs what changed
+ * rather than the panel size.  No hardware dependencies, PIXEL needs a
+ * PIXEL(r, g, b) constructor.
+ */
+class Scene
+{
+public:
+    Scene() { clear(); }
+
+    void clear() { memset(_nodes, 0, sizeof(_nodes)); }
+
+    void rect(int slot, int x, int y, int width, int height, uint32_t color)
+    {
+        set(slot, SceneNode::RECT, x, y, width, height, color, 0);
+    }
+
+    void digits(int slot, int x, int y, int value, uint32_t color)
+    {
+        set(slot, SceneNode::DIGITS, x, y, 0, 0, color, value);
+    }
+
+    void box(int slot, int x, int y, int width, int height, uint32_t color)
+    {
+        set(slot, SceneNode::BOX, x, y, width, height, color, 0);
+    }
+
+    const SceneNode& node(int slot) const { return _nodes[slot]; }
+
+    bool operator==(const Scene& other) const
+    {
+        for (int i = 0; i < SCENE_MAX_NODES; ++i)
+        {
+            if (_nodes[i] != other._nodes[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const Scene& other) const { return !(*this == other); }
+
+    // draw every node over whatever is already in the buffer
+    template<class PIXEL>
+    void paint(PIXEL* buffer, int width, int height, const DigitAtlas& atlas) const
+    {
+        SceneRect all = { 0, 0, (int16_t)width, (int16_t)height };
+        for (int i = 0; i < SCENE_MAX_NODES; ++i)
+        {
+            draw(buffer, width, atlas, _nodes[i], all);
+        }
+    }
+
+    // buffer holds previous, repaint what differs, returns the rectangles repainted
+    template<class PIXEL>
+    int update(PIXEL* buffer, int width, int height, const DigitAtlas& atlas, const Scene& previous) const
+    {
+        SceneRect panel = { 0, 0, (int16_t)width, (int16_t)height };
+        int       count = 0;
+        for (int i = 0; i < SCENE_MAX_NODES; ++i)
+        {
+            const SceneNode& now = _nodes[i];
+            const SceneNode& was = previous._nodes[i];
+            if (now == was)
+            {
+                continue;
+            }
+            SceneRect damage[8];
+            int n = this->damage(now, atlas, damage);
+            // a moved or replaced node also leaves its old pixels behind
+            if (!now.sameShape(was))
+            {
+                n += this->damage(was, atlas, damage + n);
+            }
+            for (int d = 0; d < n; ++d)
+            {
+                SceneRect clip = damage[d].intersect(panel);
+                if (!clip.empty())
+                {
+                    repaint(buffer, width, atlas, clip);
+                    ++count;
+                }
+            }
+        }
+        return count;
+    }
+
+    // bounding box of a node, empty for NONE
+    SceneRect bounds(const SceneNode& node, const DigitAtlas& atlas) const
+    {
+        SceneRect r = { 0, 0, 0, 0 };
+        switch (node.kind)
+        {
+        case SceneNode::RECT:
+        case SceneNode::BOX:
+            r.x0 = node.x;
+            r.y0 = node.y;
+            r.x1 = node.x + node.width;
+            r.y1 = node.y + node.height;
+            break;
+        case SceneNode::DIGITS:
+            r.x0 = node.x;
+            r.y0 = node.y + atlas.getTop();
+            r.x1 = node.x + 2 * atlas.getAdvance();
+            r.y1 = r.y0 + atlas.getHeight();
+            break;
+        default:
+            break;
+        }
+        return r;
+    }
+
+private:
+    SceneNode _nodes[SCENE_MAX_NODES];
+
+    void set(int slot, SceneNode::Kind kind, int x, int y, int width, int height, uint32_t color, int value)
+    {
+        SceneNode& node = _nodes[slot];
+        node.kind   = kind;
+        node.value  = value;
+        node.x      = x;
+        node.y      = y;
+        node.width  = width;
+        node.height = height;
+        node.color  = color;
+    }
+
+    // a box only touches its outline, so a blink repaints 4 thin strips
+    int damage(const SceneNode& node, const DigitAtlas& atlas, SceneRect* out) const
+    {
+        SceneRect r = bounds(node, atlas);
+        if (r.empty())
+        {
+            return 0;
+        }
+        if (node.kind != SceneNode::BOX || node.width <= 2 * SCENE_BOX_WIDTH || node.height <= 2 * SCENE_BOX_WIDTH)
+        {
+            out[0] = r;
+            return 1;
+        }
+        const int16_t b = SCENE_BOX_WIDTH;
+        SceneRect top    = { r.x0,     r.y0,     r.x1,     (int16_t)(r.y0 + b) };
+        SceneRect bottom = { r.x0,     (int16_t)(r.y1 - b), r.x1, r.y1 };
+        SceneRect left   = { r.x0,     (int16_t)(r.y0 + b), (int16_t)(r.x0 + b), (int16_t)(r.y1 - b) };
+        SceneRect right  = { (int16_t)(r.x1 - b), (int16_t)(r.y0 + b), r.x1, (int16_t)(r.y1 - b) };
+        out[0] = top;
+        out[1] = bottom;
+        out[2] = left;
+        out[3] = right;
+        return 4;
+    }
+
+    // start from the highest solid rect that covers the clip, black if none
+    template<class PIXEL>
+    void repaint(PIXEL* buffer, int width, const DigitAtlas& atlas, const SceneRect& clip) const
+    {
+        int first = SCENE_MAX_NODES - 1;
+        while (first >= 0 && !(_nodes[first].kind == SceneNode::RECT && bounds(_nodes[first], atlas).contains(clip)))
+        {
+            --first;
+        }
+        if (first < 0)
+        {
+            fill(buffer, width, clip, PIXEL(0, 0, 0));
+            first = 0;
+        }
+        for (int i = first; i < SCENE_MAX_NODES; ++i)
+        {
+            draw(buffer, width, atlas, _nodes[i], clip);
+        }
+    }
+
+    template<class PIXEL>
+    void draw(PIXEL* buffer, int width, const DigitAtlas& atlas, const SceneNode& node, const SceneRect& clip) const
+    {
+        SceneRect r = bounds(node, atlas).intersect(clip);
+        if (r.empty())
+        {
+            return;
+        }
+        PIXEL color((node.color >> 16) & 0xff, (node.color >> 8) & 0xff, node.color & 0xff);
+        switch (node.kind)
+        {
+        case SceneNode::RECT:
+            fill(buffer, width, r, color);
+            break;
+        case SceneNode::DIGITS:
+            atlas.blit2(buffer, width, node.x, node.y, node.value, color, r.x0, r.y0, r.x1, r.y1);
+            break;
+        case SceneNode::BOX:
+        {
+            SceneRect strips[4];
+            int n = damage(node, atlas, strips);
+            for (int i = 0; i < n; ++i)
+            {
+                fill(buffer, width, strips[i].intersect(r), color);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    template<class PIXEL>
+    static void fill(PIXEL* buffer, int width, const SceneRect& r, const PIXEL& color)
+    {
+        for (int y = r.y0; y < r.y1; ++y)
+        {
+            PIXEL* line = buffer + y * width;
+            for (int x = r.x0; x < r.x1; ++x)
+            {
+                line[x] = color;
+            }
+        }
+    }
+};
+
+#endif // SCENE_H_
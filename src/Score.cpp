@@ -33,133 +33,149 @@
 
 static const char* TAG = "Score";
 
-Score::Score()
-: _limit(DEFAULT_SCORE_LIMIT),
-  _max_limit(DEFAULT_SCORE_MAX_LIMIT),
-  _score(), 
-  _swappped(false)
+Score::State::State()
+: _packed(0)
 {
+    *this = withFormat(DEFAULT_SCORE_FORMAT);
 }
 
-Score::~Score()
+Score::State Score::State::withTeamScore(Team team, int score) const
 {
+    int shift = team * SCORE_BITS;
+    return State((_packed & ~(SCORE_MASK << shift)) | ((score & SCORE_MASK) << shift));
 }
 
-void Score::swap()
+Score::State Score::State::withLimits(int limit, int max_limit) const
 {
-    dlog.info(TAG, "Score::swap()");
-    _swappped = !_swappped;
+    uint32_t packed = _packed & ~((LIMIT_MASK << LIMIT_SHIFT) | (LIMIT_MASK << MAX_LIMIT_SHIFT));
+    packed |= (limit & LIMIT_MASK) << LIMIT_SHIFT;
+    packed |= (max_limit & LIMIT_MASK) << MAX_LIMIT_SHIFT;
+    return State(packed);
 }
 
-void Score::reset()
+Score::State Score::State::withFormat(ScoreFormat format) const
 {
-    dlog.info(TAG, "Score::reset()");
-    for(int i = 0; i < NUM_TEAMS; ++i)
+    State state = State((_packed & ~(FORMAT_MASK << FORMAT_SHIFT)) | ((format & FORMAT_MASK) << FORMAT_SHIFT));
+    if (format == FORMAT_CUSTOM)
     {
-        _score[i] = 0;
+        return state;
     }
-    _swappped = false;
+    return state.withLimits(formatLimit(format), formatMaxLimit(format));
 }
 
-void Score::setLimits(int limit, int max_limit)
+Score::State Score::State::withSwapped(bool swapped) const
 {
-    dlog.info(TAG, "Score::setLimits: %d/%d", limit, max_limit);
-    _limit     = limit;
-    _max_limit = max_limit;
+    return State((_packed & ~(1u << SWAPPED_SHIFT)) | ((uint32_t)swapped << SWAPPED_SHIFT));
 }
 
-Score::Side Score::getSide(Team team)
+namespace
 {
-    Side side = LHS;
-    if (team == BLUE)
-    {
-        side = RHS;
-    }
-    if (_swappped)
+    // one switch on the format tag, then the rule type's inlined table load
+    struct Flags
     {
-        if (side == LHS)
-        {
-            side = RHS;
-        } else if (side == RHS)
-        {
-            side = LHS;
-        }
-    }
-    return side;
+        int red;
+        int blue;
+        int limit;
+        int max_limit;
+        template<class RULES> uint8_t operator()() const { return RULES::flags(red, blue); }
+        uint8_t custom() const { return ScoreRules::flags(limit, max_limit, red, blue); }
+    };
 }
 
-Score::Team Score::getLeader()
+uint8_t Score::State::flags() const
 {
-    return _score[BLUE] > _score[RED] ? BLUE : RED;
+    Flags visitor = {getTeamScore(RED), getTeamScore(BLUE), getLimit(), getMaxLimit()};
+    return visitFormat<uint8_t>(getFormat(), visitor);
 }
 
-Score::Team Score::getTeam(Side side)
+Score::Score()
+: _state(State()._packed)
+{
+}
+
+Score::~Score()
 {
-    Team team = RED;
-    if (side == RHS)
-    {
-        team = BLUE;
-    }
-    if (_swappped)
-    {
-        if (team == RED)
-        {
-            team = BLUE;
-        } else if (team == BLUE)
-        {
-            team = RED;
-        }
-    }
-    return team;
 }
 
-int Score::getScore(Side side)
+Score::State Score::snapshot() const
 {
-    Team team = getTeam(side);
-    return _score[team];
+    return State(_state.load(std::memory_order_acquire));
 }
 
-void Score::incrementScore(Side side, int increment)
+bool Score::publish(State& expected, State next)
 {
-    dlog.info(TAG, "Score::incrementScore: %s by %d", side == LHS ? "LHS" : "RHS", increment);
-    if (isGameOver())
+    return _state.compare_exchange_weak(expected._packed, next._packed, std::memory_order_acq_rel);
+}
+
+void Score::swap()
+{
+    dlog.info(TAG, "Score::swap()");
+    State state = snapshot();
+    while (!publish(state, state.withSwapped(!state.isSwapped())))
     {
-        // no score can go up if game is over and only the winner can go down
-        if (increment > 0 || getSide(getLeader()) != side)
-        {
-            return;
-        }
     }
-    Team team = getTeam(side);
-    int score = _score[team] + increment;
+}
 
-    // can't go negative
-    if (score < 0)
+void Score::reset(bool swapped)
+{
+    dlog.info(TAG, "Score::reset(%s)", swapped ? "swapped" : "");
+    State state = snapshot();
+    while (!publish(state, state.withTeamScore(RED, 0).withTeamScore(BLUE, 0).withSwapped(swapped)))
     {
-        return;
     }
-    _score[team] = score;
 }
 
-bool Score::isGameOver()
+void Score::setLimits(int limit, int max_limit)
 {
-    // return if no one has reached the limit
-    if (_score[RED] < _limit && _score[BLUE] < _limit)
+    dlog.info(TAG, "Score::setLimits: %d/%d", limit, max_limit);
+    limit     = constrain(limit, 1, State::LIMIT_MASK);
+    max_limit = constrain(max_limit, limit, State::LIMIT_MASK);
+    State state = snapshot();
+    while (!publish(state, state.withFormat(FORMAT_CUSTOM).withLimits(limit, max_limit)))
     {
-        return false;
     }
+}
+
+void Score::restore(const State& state)
+{
+    dlog.info(TAG, "Score::restore: %d-%d", state.getTeamScore(RED), state.getTeamScore(BLUE));
+    _state.store(state._packed, std::memory_order_release);
+}
 
-    // if more than 1 point lead wins
-    if (abs(_score[RED] - _score[BLUE]) > 1)
+void Score::setFormat(ScoreFormat format)
+{
+    dlog.info(TAG, "Score::setFormat: %s", formatName(format));
+    State state = snapshot();
+    while (!publish(state, state.withFormat(format)))
     {
-        return true;
     }
+}
 
-    // first one to max_limit wins
-    if (_score[RED] >= _max_limit || _score[BLUE] >= _max_limit)
+void Score::incrementScore(Side side, int increment)
+{
+    dlog.info(TAG, "Score::incrementScore: %s by %d", side == LHS ? "LHS" : "RHS", increment);
+    State state = snapshot();
+    do
     {
-        return true;
-    }
+        if (state.isGameOver())
+        {
+            // no score can go up if game is over and only the winner can go down
+            if (increment > 0 || state.getSide(state.getLeader()) != side)
+            {
+                return;
+            }
+        }
+        Team team = state.getTeam(side);
+        int score = state.getTeamScore(team) + increment;
 
-    return false;
+        // can't go negative (or past what fits in the packed state)
+        if (score < 0 || score > State::SCORE_MASK)
+        {
+            return;
+        }
+        if (publish(state, state.withTeamScore(team, score)))
+        {
+            return;
+        }
+    } while (true);
 }
@@ -31,8 +31,11 @@
 #ifndef SCORE_H_
 #define SCORE_H_
 
-#define DEFAULT_SCORE_LIMIT 21
-#define DEFAULT_SCORE_MAX_LIMIT 30
+#include <stdint.h>
+#include <atomic>
+#include "ScoreFormat.h"
+
+#define DEFAULT_SCORE_FORMAT FORMAT_BADMINTON_21
 
 class Score
 {
@@ -40,23 +43,72 @@ public:
     // when not swapped RED is on the LHS
     enum Team {RED = 0, BLUE = 1, NUM_TEAMS};
     enum Side {LHS = 0, RHS = 1, NUM_SIDES};
+
+    /**
+     * Immutable copy of the whole game state packed into a single word so that
+     * it can be published and read atomically from any task.
+     *
+     *  bits  0-6  RED score
+     *  bits  7-13 BLUE score
+     *  bits 14-20 limit
+     *  bits 21-27 max limit
+     *  bits 28-30 format (ScoreFormat)
+     *  bit  31    swapped
+     */
+    class State
+    {
+    public:
+        State();
+        Side getSide(Team team) const { return (Side)(team ^ isSwapped()); }
+        Team getTeam(Side side) const { return (Team)(side ^ isSwapped()); }
+        int  getTeamScore(Team team) const { return (_packed >> (team * SCORE_BITS)) & SCORE_MASK; }
+        int  getScore(Side side) const { return getTeamScore(getTeam(side)); }
+        Team getLeader() const { return getTeamScore(BLUE) > getTeamScore(RED) ? BLUE : RED; }
+        bool isGamePoint(Team team) const { return flags() & (team == RED ? SCORE_RED_GAME_POINT : SCORE_BLUE_GAME_POINT); }
+        bool isGameOver() const { return flags() & SCORE_GAME_OVER; }
+        uint8_t flags() const;
+        int  getLimit() const { return (_packed >> LIMIT_SHIFT) & LIMIT_MASK; }
+        int  getMaxLimit() const { return (_packed >> MAX_LIMIT_SHIFT) & LIMIT_MASK; }
+        ScoreFormat getFormat() const { return (ScoreFormat)((_packed >> FORMAT_SHIFT) & FORMAT_MASK); }
+        bool isSwapped() const { return (_packed >> SWAPPED_SHIFT) & 1; }
+        bool operator==(const State& other) const { return _packed == other._packed; }
+        bool operator!=(const State& other) const { return _packed != other._packed; }
+        // raw word for persisting, fromPacked() is the inverse
+        uint32_t getPacked() const { return _packed; }
+        static State fromPacked(uint32_t packed) { return State(packed); }
+
+        static const int SCORE_BITS      = 7;
+        static const int SCORE_MASK      = (1 << SCORE_BITS) - 1;
+        static const int LIMIT_MASK      = (1 << 7) - 1;
+
+    private:
+        friend class Score;
+        static const int LIMIT_SHIFT     = 14;
+        static const int MAX_LIMIT_SHIFT = 21;
+        static const int FORMAT_SHIFT    = 28;
+        static const int FORMAT_MASK     = (1 << 3) - 1;
+        static const int SWAPPED_SHIFT   = 31;
+        explicit State(uint32_t packed) : _packed(packed) {}
+        State withTeamScore(Team team, int score) const;
+        State withLimits(int limit, int max_limit) const;
+        State withFormat(ScoreFormat format) const;
+        State withSwapped(bool swapped) const;
+        uint32_t _packed;
+    };
+
     Score();
     virtual ~Score();
+    State snapshot() const;
     void swap();
-    void reset();
+    void reset(bool swapped = false);
     void setLimits(int limit, int max_limit);
-    Side getSide(Team team);
-    Team getTeam(Side side);
-    Team getLeader();
-    int getScore(Side side);
+    void setFormat(ScoreFormat format);
     void incrementScore(Side side, int increment);
-    bool isGameOver();
+    void restore(const State& state);
 
 private:
-    volatile int  _limit;
-    volatile int  _max_limit;
-    volatile int  _score[NUM_TEAMS];
-    volatile bool _swappped;
+    std::atomic<uint32_t> _state;
+    bool publish(State& expected, State next);
 };
 
 #endif /* SCORE_H_ */
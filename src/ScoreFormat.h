@@ -0,0 +1,156 @@
+/**
+ * @file ScoreFormat.h
+ * @author Christoper B. Liebman
+ * @brief game formats (rule sets) the scoreboard can keep score for
+ * @version 0.1
+ * @date 2020-12-20
+ *
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef SCORE_FORMAT_H_
+#define SCORE_FORMAT_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "ScoreTable.h"
+
+/**
+ * Tag for the rule set in use, chosen once in CHOOSING and kept in the
+ * packed score state.  CUSTOM evaluates ScoreRules with the limits from the
+ * state, every other tag maps to a WinByTwo<> type below.
+ */
+enum ScoreFormat
+{
+    FORMAT_CUSTOM = 0,
+    FORMAT_BADMINTON_21,    // 21 points, win by 2, 30 wins outright
+    FORMAT_BADMINTON_15,    // short game, 15 points, 20 wins outright
+    FORMAT_BADMINTON_3X15,  // 3x15 trial format, 15 points, 21 wins outright
+    FORMAT_TABLE_TENNIS,    // 11 points, win by 2, no cap
+    FORMAT_RALLY_25,        // volleyball style rally scoring, 25 points, win by 2, no cap
+    NUM_FORMATS
+};
+
+/**
+ * A rule set as a type: first to LIMIT with a 2 point lead wins, first to
+ * MAX_LIMIT wins outright (0 for no cap).  Everything is static so calls
+ * through a known type inline down to the table load.
+ */
+template<int LIMIT, int MAX_LIMIT>
+struct WinByTwo
+{
+    static constexpr int limit     = LIMIT;
+    static constexpr int max_limit = MAX_LIMIT;
+    typedef ScoreTable<LIMIT, MAX_LIMIT> Table;
+
+    static constexpr bool isGameOver(int red, int blue)
+    {
+        return ScoreRules::isGameOver(LIMIT, MAX_LIMIT, red, blue);
+    }
+
+    static uint8_t flags(int red, int blue)
+    {
+        if (Table::contains(red, blue))
+        {
+            return Table::flags(red, blue);
+        }
+        return ScoreRules::flags(LIMIT, MAX_LIMIT, red, blue);
+    }
+};
+
+template<ScoreFormat FORMAT>
+struct FormatRules;
+
+template<> struct FormatRules<FORMAT_BADMINTON_21>   : WinByTwo<21, 30> { static constexpr const char* name = "badminton_21"; };
+template<> struct FormatRules<FORMAT_BADMINTON_15>   : WinByTwo<15, 20> { static constexpr const char* name = "badminton_15"; };
+template<> struct FormatRules<FORMAT_BADMINTON_3X15> : WinByTwo<15, 21> { static constexpr const char* name = "badminton_3x15"; };
+template<> struct FormatRules<FORMAT_TABLE_TENNIS>   : WinByTwo<11, 0>  { static constexpr const char* name = "table_tennis"; };
+template<> struct FormatRules<FORMAT_RALLY_25>       : WinByTwo<25, 0>  { static constexpr const char* name = "rally_25"; };
+
+/**
+ * Visit the rule type for a runtime tag, V provides
+ *   template<class RULES> R operator()() const
+ * and a custom() fallback for FORMAT_CUSTOM.
+ */
+template<class R, class V>
+R visitFormat(ScoreFormat format, const V& visitor)
+{
+    switch (format)
+    {
+    case FORMAT_BADMINTON_21:   return visitor.template operator()<FormatRules<FORMAT_BADMINTON_21>>();
+    case FORMAT_BADMINTON_15:   return visitor.template operator()<FormatRules<FORMAT_BADMINTON_15>>();
+    case FORMAT_BADMINTON_3X15: return visitor.template operator()<FormatRules<FORMAT_BADMINTON_3X15>>();
+    case FORMAT_TABLE_TENNIS:   return visitor.template operator()<FormatRules<FORMAT_TABLE_TENNIS>>();
+    case FORMAT_RALLY_25:       return visitor.template operator()<FormatRules<FORMAT_RALLY_25>>();
+    default:                    return visitor.custom();
+    }
+}
+
+namespace score_format
+{
+    struct Name
+    {
+        template<class RULES> const char* operator()() const { return RULES::name; }
+        const char* custom() const { return "custom"; }
+    };
+
+    struct Limit
+    {
+        template<class RULES> int operator()() const { return RULES::limit; }
+        int custom() const { return 0; }
+    };
+
+    struct MaxLimit
+    {
+        template<class RULES> int operator()() const { return RULES::max_limit; }
+        int custom() const { return 0; }
+    };
+}
+
+inline const char* formatName(ScoreFormat format)
+{
+    return visitFormat<const char*>(format, score_format::Name());
+}
+
+inline int formatLimit(ScoreFormat format)
+{
+    return visitFormat<int>(format, score_format::Limit());
+}
+
+inline int formatMaxLimit(ScoreFormat format)
+{
+    return visitFormat<int>(format, score_format::MaxLimit());
+}
+
+// FORMAT_CUSTOM if the name is unknown
+inline ScoreFormat formatFromName(const char* name)
+{
+    for (int i = FORMAT_CUSTOM + 1; i < NUM_FORMATS; ++i)
+    {
+        if (strcmp(name, formatName((ScoreFormat)i)) == 0)
+        {
+            return (ScoreFormat)i;
+        }
+    }
+    return FORMAT_CUSTOM;
+}
+
+#endif // SCORE_FORMAT_H_
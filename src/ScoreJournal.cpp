@@ -0,0 +1,225 @@
+/**
+ * @file ScoreJournal.cpp
+ * @author Christoper B. Liebman
+ * @brief keeps the game in a flash journal across resets
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#include "ScoreJournal.h"
+#include "Log.h"
+
+#if CONFIG_FREERTOS_UNICORE
+#define ARDUINO_RUNNING_CORE 0
+#else
+#define ARDUINO_RUNNING_CORE 1
+#endif
+
+static const char* TAG = "ScoreJournal";
+
+FSJournalStore::FSJournalStore(fs::FS& fs, const char* path)
+: _fs(fs),
+  _path(path),
+  _tmp_path(String(path) + ".tmp"),
+  _file()
+{
+}
+
+bool FSJournalStore::begin()
+{
+    // finish a rewrite that was interrupted between the remove and the rename
+    if (!_fs.exists(_path) && _fs.exists(_tmp_path))
+    {
+        dlog.warning(TAG, "begin: finishing interrupted rewrite");
+        _fs.rename(_tmp_path, _path);
+    }
+    _file = _fs.open(_path, FILE_APPEND);
+    return (bool)_file;
+}
+
+size_t FSJournalStore::size()
+{
+    return _file ? _file.size() : 0;
+}
+
+size_t FSJournalStore::read(size_t offset, uint8_t* data, size_t len)
+{
+    fs::File f = _fs.open(_path, FILE_READ);
+    if (!f || !f.seek(offset))
+    {
+        return 0;
+    }
+    size_t count = f.read(data, len);
+    f.close();
+    return count;
+}
+
+bool FSJournalStore::append(const uint8_t* data, size_t len)
+{
+    return _file && _file.write(data, len) == len;
+}
+
+bool FSJournalStore::sync()
+{
+    if (!_file)
+    {
+        return false;
+    }
+    _file.flush();
+    return true;
+}
+
+bool FSJournalStore::rewrite(const uint8_t* data, size_t len)
+{
+    fs::File tmp = _fs.open(_tmp_path, FILE_WRITE);
+    if (!tmp)
+    {
+        return false;
+    }
+    bool ok = len == 0 || tmp.write(data, len) == len;
+    tmp.close();
+    if (!ok)
+    {
+        _fs.remove(_tmp_path);
+        return false;
+    }
+    _file.close();
+    _fs.remove(_path);
+    ok = _fs.rename(_tmp_path, _path);
+    _file = _fs.open(_path, FILE_APPEND);
+    return ok && _file;
+}
+
+ScoreJournal::ScoreJournal(App& app, fs::FS& fs)
+: _app(app),
+  _store(fs, JOURNAL_FILE),
+  _journal(_store),
+  _task(nullptr),
+  _resumed(false),
+  _entries()
+{
+}
+
+/**
+ * Load the journal (the file system must already be mounted) and resume the
+ * saved game if it had started, then start journaling.
+ */
+bool ScoreJournal::begin()
+{
+    uint32_t start = millis();
+    if (!_store.begin())
+    {
+        dlog.error(TAG, "begin: failed to open '%s'", JOURNAL_FILE);
+        return false;
+    }
+
+    JournalRecord last;
+    if (_journal.load(last))
+    {
+        Score::State state = Score::State::fromPacked(last.score);
+        Match::State match = Match::State::fromPacked(last.match);
+        dlog.info(TAG, "begin: %zu records, last %d-%d game %d (%u ms)", _journal.records(),
+                  state.getTeamScore(Score::RED), state.getTeamScore(Score::BLUE), match.getGame() + 1,
+                  millis() - start);
+        // a game that has not started yet still goes through CHOOSING
+        bool started = state.getTeamScore(Score::RED) != 0 || state.getTeamScore(Score::BLUE) != 0 ||
+                       match.getGame() != 0 || match.getGamesWon(Score::RED) != 0 || match.getGamesWon(Score::BLUE) != 0;
+        if (started)
+        {
+            _app.resume(state, match);
+            _resumed = true;
+        }
+    }
+
+    dlog.info(TAG, "begin: Creating journal task...");
+    xTaskCreatePinnedToCore(&taskGateway<ScoreJournal>, "Journal", 4096, this, 1, &_task, ARDUINO_RUNNING_CORE);
+    // the mode alone is not journaled, it follows from the score
+    _app.events().subscribe(Delegate<ScoreChanged>::bind<ScoreJournal, &ScoreJournal::changed>(this),
+                            CHANGE_ALL & ~CHANGE_MODE);
+    return true;
+}
+
+void ScoreJournal::changed(const ScoreChanged& event)
+{
+    // runs on the App task, never block it on flash
+    if (!_entries.push({event.state.getPacked(), event.match.getPacked()}))
+    {
+        dlog.error(TAG, "changed: queue full, dropping version %u", event.version);
+    }
+    xTaskNotifyGive(_task);
+}
+
+void ScoreJournal::task()
+{
+    TickType_t wait    = portMAX_DELAY;
+    uint32_t   first   = 0;   // when the oldest uncommitted change arrived, or the last failed commit
+    uint32_t   backoff = 0;   // ms until the next retry, 0 while commits succeed
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        JournalEntry entry;
+        while (_entries.pop(entry))
+        {
+            if (_journal.pending() == 0)
+            {
+                first = millis();
+            }
+            _journal.append(entry.score, entry.match);
+        }
+
+        wait = portMAX_DELAY;
+        if (_journal.pending() == 0)
+        {
+            continue;
+        }
+        uint32_t age = millis() - first;
+        uint32_t due = backoff ? backoff : JOURNAL_COMMIT_MS;
+        if (age >= due)
+        {
+            uint32_t start = millis();
+            if (_journal.commit())
+            {
+                backoff = 0;
+            }
+            else
+            {
+                // the newest record is still pending, try again later rather than waiting for a change
+                backoff = backoff ? backoff * 2 : JOURNAL_RETRY_MS;
+                if (backoff > JOURNAL_RETRY_MAX_MS)
+                {
+                    backoff = JOURNAL_RETRY_MAX_MS;
+                }
+                first = millis();
+                wait  = backoff / portTICK_PERIOD_MS + 1;
+                dlog.error(TAG, "task: commit failed, retrying in %u ms", backoff);
+            }
+            dlog.debug(TAG, "task: commit %u took %u ms, %zu records", _journal.commits(), millis() - start, _journal.records());
+        }
+        else
+        {
+            wait = (due - age) / portTICK_PERIOD_MS + 1;
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file ScoreJournal.h
+ * @author Christoper B. Liebman
+ * @brief keeps the game in a flash journal across resets
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef SCORE_JOURNAL_H_
+#define SCORE_JOURNAL_H_
+
+#include <Arduino.h>
+#include <FS.h>
+#include "App.h"
+#include "Journal.h"
+#include "LockFreeQueue.h"
+#include "TaskGateway.h"
+
+#ifndef JOURNAL_COMMIT_MS
+#define JOURNAL_COMMIT_MS 1000          // longest a change waits for its group commit
+#endif
+
+#ifndef JOURNAL_RETRY_MS
+#define JOURNAL_RETRY_MS 250            // first retry after a failed commit, doubles each time
+#endif
+
+#ifndef JOURNAL_RETRY_MAX_MS
+#define JOURNAL_RETRY_MAX_MS 30000      // longest wait between retries
+#endif
+
+#define JOURNAL_FILE "/journal.bin"
+
+/**
+ * Journal kept in a file on an already mounted file system (SPIFFS), which
+ * does its own wear levelling.  rewrite() goes through a temp file and a
+ * rename so a reset part way leaves either the old or the new journal.
+ */
+class FSJournalStore : public JournalStore
+{
+public:
+    FSJournalStore(fs::FS& fs, const char* path);
+    bool   begin();
+    size_t size() override;
+    size_t read(size_t offset, uint8_t* data, size_t len) override;
+    bool   append(const uint8_t* data, size_t len) override;
+    bool   sync() override;
+    bool   rewrite(const uint8_t* data, size_t len) override;
+
+private:
+    fs::FS&     _fs;
+    String      _path;
+    String      _tmp_path;
+    fs::File    _file;      // open for append
+};
+
+/**
+ * Restores the last game at boot and journals every change after that.
+ * Changes arrive on the App task through the event bus and are committed
+ * in groups by the journal task at most JOURNAL_COMMIT_MS later.  A failed
+ * commit is retried with a doubling backoff until the snapshot is written,
+ * so the last score reaches flash even if nothing changes after it.
+ */
+class ScoreJournal
+{
+public:
+    ScoreJournal(App& app, fs::FS& fs);
+    bool begin();
+    bool resumed() const { return _resumed; }
+    void changed(const ScoreChanged& event);
+
+private:
+    typedef struct journal_entry {
+        uint32_t score;
+        uint32_t match;
+    } JournalEntry;
+
+    App&                           _app;
+    FSJournalStore                 _store;
+    Journal                        _journal;
+    TaskHandle_t                   _task;
+    bool                           _resumed;   // begin() restored a game
+    SpscQueue<JournalEntry, 16>    _entries;   // filled by the App task
+
+    void task();
+    friend void taskGateway<ScoreJournal>(void* data);
+};
+
+#endif // SCORE_JOURNAL_H_
@@ -0,0 +1,129 @@
+/**
+ * @file ScoreTable.h
+ * @author Christoper B. Liebman
+ * @brief compile time game over/leader/game point tables
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+#ifndef SCORE_TABLE_H_
+#define SCORE_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+// status bits for a (red, blue) score
+#define SCORE_GAME_OVER       (1 << 0)
+#define SCORE_BLUE_LEADS      (1 << 1)   // otherwise RED is the leader (ties go to RED)
+#define SCORE_RED_GAME_POINT  (1 << 2)   // one more RED point ends the game
+#define SCORE_BLUE_GAME_POINT (1 << 3)   // one more BLUE point ends the game
+
+/**
+ * The scoring rules as constexpr functions so the same code builds the
+ * tables at compile time and handles limits that have no table at runtime.
+ */
+struct ScoreRules
+{
+    static constexpr int diff(int a, int b)
+    {
+        return a > b ? a - b : b - a;
+    }
+
+    // someone reached the limit and either leads by 2 or reached max_limit (0 for no cap)
+    static constexpr bool isGameOver(int limit, int max_limit, int red, int blue)
+    {
+        return (red >= limit || blue >= limit) &&
+               (diff(red, blue) > 1 || (max_limit > 0 && (red >= max_limit || blue >= max_limit)));
+    }
+
+    static constexpr uint8_t flags(int limit, int max_limit, int red, int blue)
+    {
+        return (isGameOver(limit, max_limit, red, blue) ? SCORE_GAME_OVER : 0) |
+               (blue > red ? SCORE_BLUE_LEADS : 0) |
+               (!isGameOver(limit, max_limit, red, blue) && isGameOver(limit, max_limit, red + 1, blue) ? SCORE_RED_GAME_POINT : 0) |
+               (!isGameOver(limit, max_limit, red, blue) && isGameOver(limit, max_limit, red, blue + 1) ? SCORE_BLUE_GAME_POINT : 0);
+    }
+};
+
+namespace score_table
+{
+    // index sequence built in log(N) steps so large tables don't hit the template depth limit
+    template<size_t... I>
+    struct Indices
+    {
+        typedef Indices<I..., (sizeof...(I) + I)...> Doubled;
+        typedef Indices<I..., (sizeof...(I) + I)..., 2 * sizeof...(I)> DoubledPlusOne;
+    };
+
+    template<size_t N>
+    struct MakeIndices
+    {
+        typedef typename std::conditional<N % 2,
+            typename MakeIndices<N / 2>::Type::DoubledPlusOne,
+            typename MakeIndices<N / 2>::Type::Doubled>::type Type;
+    };
+
+    template<>
+    struct MakeIndices<0>
+    {
+        typedef Indices<> Type;
+    };
+
+    template<int LIMIT, int MAX_LIMIT, int DIM, class INDICES>
+    struct Data;
+
+    template<int LIMIT, int MAX_LIMIT, int DIM, size_t... I>
+    struct Data<LIMIT, MAX_LIMIT, DIM, Indices<I...>>
+    {
+        static constexpr uint8_t flags[sizeof...(I)] = {ScoreRules::flags(LIMIT, MAX_LIMIT, I / DIM, I % DIM)...};
+    };
+
+    template<int LIMIT, int MAX_LIMIT, int DIM, size_t... I>
+    constexpr uint8_t Data<LIMIT, MAX_LIMIT, DIM, Indices<I...>>::flags[sizeof...(I)];
+}
+
+/**
+ * Status flags for every score from 0-0 to TOP-TOP, indexed by
+ * red * (TOP + 1) + blue.  With a max limit scores can't go past it so this
+ * covers every reachable state, without one (MAX_LIMIT 0) the table covers a
+ * long deuce and callers fall back to ScoreRules past that.
+ */
+template<int LIMIT, int MAX_LIMIT, int TOP = (MAX_LIMIT > 0 ? MAX_LIMIT : LIMIT + 9)>
+struct ScoreTable
+{
+    static constexpr int DIM = TOP + 1;
+    typedef score_table::Data<LIMIT, MAX_LIMIT, DIM, typename score_table::MakeIndices<DIM * DIM>::Type> Table;
+
+    static bool contains(int red, int blue)
+    {
+        return red <= TOP && blue <= TOP;
+    }
+
+    static uint8_t flags(int red, int blue)
+    {
+        return Table::flags[red * DIM + blue];
+    }
+};
+
+#endif // SCORE_TABLE_H_
@@ -93,11 +93,18 @@ void ScoreboardClient::onMessage(WebsocketInputStreambuf * input)
             int max_limit = doc["max_limit"];
             if (limit > 0 && max_limit > 0)
             {
+                // also moves CHOOSING on to RUNNING
                 app.setLimits(limit, max_limit);
-                if (app.mode() == AppMode::CHOOSING)
-                {
-                    app.mode(AppMode::RUNNING);
-                }
+            }
+        }
+        else if (action == "format")
+        {
+            // {"action":"format","format":"badminton_21"}
+            ScoreFormat format = formatFromName(doc["format"] | "");
+            if (format != FORMAT_CUSTOM)
+            {
+                // also moves CHOOSING on to RUNNING
+                app.setFormat(format);
             }
         }
         else if (action == "swap")
@@ -110,6 +117,21 @@ void ScoreboardClient::onMessage(WebsocketInputStreambuf * input)
             // {"action":"reset"}
             app.reset();
         }
+        else if (action == "undo")
+        {
+            // {"action":"undo"}
+            app.undo();
+        }
+        else if (action == "redo")
+        {
+            // {"action":"redo"}
+            app.redo();
+        }
+        else if (action == "new_match")
+        {
+            // {"action":"new_match"}
+            app.newMatch();
+        }
     }
     else
     {
@@ -0,0 +1,131 @@
+/**
+ * @file SmartMatrixTarget.cpp
+ * @author Christoper B. Liebman
+ * @brief render target on the SmartMatrix HUB75 panel
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#include "SmartMatrixTarget.h"
+#include <MatrixHardware_ESP32_V0.h>
+#include <SmartMatrix.h>
+
+#define COLOR_DEPTH 24                  // known working: 24, 48 - If the sketch uses type `rgb24` directly, COLOR_DEPTH must be 24
+static const uint8_t kMatrixWidth = 64;        // known working: 32, 64, 96, 128
+static const uint8_t kMatrixHeight = 32;       // known working: 16, 32, 48, 64
+static const uint8_t kRefreshDepth = 24;       // known working: 24, 36, 48
+static const uint8_t kDmaBufferRows = 2;       // known working: 2-4, use 2 to save memory, more to keep from dropping frames and automatically lowering refresh rate
+static const uint8_t kPanelType = SMARTMATRIX_HUB75_32ROW_MOD16SCAN;
+static const uint8_t kMatrixOptions = (SMARTMATRIX_OPTIONS_NONE);
+static const uint8_t kBackgroundLayerOptions = (SM_BACKGROUND_OPTIONS_NONE);
+static const uint8_t kScrollingLayerOptions = (SM_SCROLLING_OPTIONS_NONE);
+
+SMARTMATRIX_ALLOCATE_BUFFERS(matrix, kMatrixWidth, kMatrixHeight, kRefreshDepth, kDmaBufferRows, kPanelType, kMatrixOptions);
+SMARTMATRIX_ALLOCATE_BACKGROUND_LAYER(backgroundLayer, kMatrixWidth, kMatrixHeight, COLOR_DEPTH, kBackgroundLayerOptions);
+SMARTMATRIX_ALLOCATE_SCROLLING_LAYER(scrollingLayer, kMatrixWidth, kMatrixHeight, COLOR_DEPTH, kScrollingLayerOptions);
+
+// same order as RenderFont
+static const fontChoices fonts[] = { font3x5, font5x7, font6x10, font8x13, gohufont11, gohufont11b };
+
+static rgb24 toRgb24(const CRGB& color)
+{
+    return rgb24(color.r, color.g, color.b);
+}
+
+SmartMatrixTarget::SmartMatrixTarget()
+: _buffer(nullptr)
+{
+}
+
+void SmartMatrixTarget::begin(uint8_t brightness)
+{
+    matrix.addLayer(&backgroundLayer);
+    matrix.addLayer(&scrollingLayer);
+    matrix.begin();
+    matrix.setBrightness(brightness);
+    backgroundLayer.setBrightness(brightness);
+    // the background is CRGB compatible, 24 bit rgb24
+    _buffer = (CRGB*)backgroundLayer.backBuffer();
+    backgroundLayer.fillScreen(rgb24(0, 0, 0));
+    backgroundLayer.swapBuffers();
+    _buffer = (CRGB*)backgroundLayer.backBuffer();
+}
+
+uint16_t SmartMatrixTarget::getWidth() const
+{
+    return kMatrixWidth;
+}
+
+uint16_t SmartMatrixTarget::getHeight() const
+{
+    return kMatrixHeight;
+}
+
+uint16_t SmartMatrixTarget::getRefreshRate()
+{
+    return matrix.getRefreshRate();
+}
+
+void SmartMatrixTarget::fillScreen(const CRGB& color)
+{
+    backgroundLayer.fillScreen(toRgb24(color));
+}
+
+void SmartMatrixTarget::fillRectangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, const CRGB& color)
+{
+    backgroundLayer.fillRectangle(x0, y0, x1, y1, toRgb24(color));
+}
+
+void SmartMatrixTarget::drawString(int16_t x, int16_t y, const CRGB& color, RenderFont font, const char* text)
+{
+    backgroundLayer.setFont(fonts[font]);
+    backgroundLayer.drawString(x, y, toRgb24(color), text);
+}
+
+void SmartMatrixTarget::show()
+{
+    backgroundLayer.swapBuffers(true);
+    _buffer = (CRGB*)backgroundLayer.backBuffer();
+}
+
+void SmartMatrixTarget::startScroll(const char* text, int scrolls, const ScrollStyle& style)
+{
+    scrollingLayer.setColor(toRgb24(style.color));
+    scrollingLayer.setMode(wrapForward);
+    scrollingLayer.setSpeed(style.speed);
+    scrollingLayer.setFont(fonts[style.font]);
+    scrollingLayer.setStartOffsetFromLeft(style.left);
+    scrollingLayer.setOffsetFromTop(style.top);
+    scrollingLayer.start(text, scrolls);
+}
+
+void SmartMatrixTarget::stopScroll()
+{
+    scrollingLayer.stop();
+}
+
+int SmartMatrixTarget::getScrollStatus()
+{
+    return scrollingLayer.getStatus();
+}
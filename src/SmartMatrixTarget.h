@@ -0,0 +1,62 @@
+/**
+ * @file SmartMatrixTarget.h
+ * @author Christoper B. Liebman
+ * @brief render target on the SmartMatrix HUB75 panel
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ */
+
+#ifndef SMART_MATRIX_TARGET_H_
+#define SMART_MATRIX_TARGET_H_
+
+#include "RenderTarget.h"
+
+/**
+ * The SmartMatrix buffers are allocated statically in SmartMatrixTarget.cpp
+ * so there is only ever one of these.
+ */
+class SmartMatrixTarget : public RenderTarget
+{
+public:
+    SmartMatrixTarget();
+    void     begin(uint8_t brightness) override;
+    uint16_t getWidth() const override;
+    uint16_t getHeight() const override;
+    uint16_t getRefreshRate() override;
+
+    CRGB*    backBuffer() override { return _buffer; }
+    void     fillScreen(const CRGB& color) override;
+    void     fillRectangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, const CRGB& color) override;
+    void     drawString(int16_t x, int16_t y, const CRGB& color, RenderFont font, const char* text) override;
+    void     show() override;
+
+    void     startScroll(const char* text, int scrolls, const ScrollStyle& style) override;
+    void     stopScroll() override;
+    int      getScrollStatus() override;
+
+private:
+    CRGB*    _buffer;   // the background back buffer, moves on every swap
+};
+
+#endif // SMART_MATRIX_TARGET_H_
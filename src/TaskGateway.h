@@ -34,7 +34,7 @@
 template<class T>
 void taskGateway(void* data)
 {
-    dlog.info("taskGateway", "data: 0x%08x", data);
+    dlog.info("taskGateway", "data: %p", data);
     ((T*)data)->task();
 }
 
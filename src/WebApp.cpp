@@ -32,6 +32,8 @@
 #include <ESPmDNS.h>
 #include <functional>
 #include "ResourceParameters.hpp"
+#include "Boot.h"
+#include "RenderStats.h"
 #include "Log.h"
 
 static const char* TAG = "WebApp";
@@ -138,11 +140,42 @@ static void handleFS(HTTPRequest * req, HTTPResponse * res)
     } 
 }
 
+// boot profile from the RAM ring, see Boot
+static void handleBootJson(HTTPRequest * req, HTTPResponse * res)
+{
+    req->discardRequestBody();
+    res->setHeader("Content-Type", "application/json");
+    Boot::getInstance().writeJson(*res);
+}
+
+static void handleBootTrace(HTTPRequest * req, HTTPResponse * res)
+{
+    req->discardRequestBody();
+    res->setHeader("Content-Type", "application/json");
+    res->setHeader("Content-Disposition", "attachment; filename=\"boot-trace.json\"");
+    Boot::getInstance().writeTrace(*res);
+}
+
+// render and refresh telemetry, ?overlay=1 (or 0) also shows it on the panel, see RenderStats
+static void handleRenderStats(HTTPRequest * req, HTTPResponse * res)
+{
+    req->discardRequestBody();
+    std::string overlay;
+    if (req->getParams()->getQueryParameter("overlay", overlay))
+    {
+        RenderStats::getInstance().setOverlay(overlay != "0");
+    }
+    res->setHeader("Content-Type", "application/json");
+    RenderStats::getInstance().writeJson(*res);
+}
+
 WebApp::WebApp() :
     _config(nullptr),
     _fs(nullptr),
     _cert(nullptr),
-    _server(nullptr)
+    _server(nullptr),
+    _pending_version(0),
+    _sent_version(0)
 {
     dlog.info(TAG, "WebApp constructor");
     _clients.reserve(MAX_SCOREBOARD_CLIENTS);
@@ -187,7 +220,7 @@ bool WebApp::begin(Config* config, FS* fs, const char* certname)
 
 void WebApp::task()
 {
-    dlog.info(TAG, "task: starting (this: 0x%08x)", this);
+    dlog.info(TAG, "task: starting (this: %p)", this);
     start();
     dlog.info(TAG, "task: looping!");
     while(true)
@@ -196,6 +229,11 @@ void WebApp::task()
         {
             _server->loop();
         }
+        // sent from here so a slow client never holds up the App task
+        if (_pending_version.load() > _sent_version)
+        {
+            updateClients();
+        }
         delay(1);
     }
 }
@@ -210,17 +248,26 @@ bool WebApp::start()
 #endif
     ResourceNode* nodeRoot      = new ResourceNode("/", "GET", &handleFS);
     ResourceNode* nodeRootIndex = new ResourceNode("/index.html", "GET", &handleFS);
+    ResourceNode* nodeBootJson  = new ResourceNode("/boot.json", "GET", &handleBootJson);
+    ResourceNode* nodeBootTrace = new ResourceNode("/boot-trace.json", "GET", &handleBootTrace);
+    ResourceNode* nodeStats     = new ResourceNode("/render-stats.json", "GET", &handleRenderStats);
     ResourceNode* node404       = new ResourceNode("", "GET", &handle404);
     WebsocketNode* nodeWS       = new WebsocketNode("/ws", &ScoreboardClient::create);
 
     // Add the root node to the server
     _server->registerNode(nodeRoot);
     _server->registerNode(nodeRootIndex);
+    _server->registerNode(nodeBootJson);
+    _server->registerNode(nodeBootTrace);
+    _server->registerNode(nodeStats);
     _server->registerNode(nodeWS);
 
     // Add the 404 not found node to the server.
     _server->setDefaultNode(node404);
-    App::getInstance().onChange(std::bind(&WebApp::updateClients, this));
+    // clients only see the mode, format, match and the per side score/color
+    App::getInstance().events().subscribe(Delegate<ScoreChanged>::bind<WebApp, &WebApp::changed>(this),
+                                          CHANGE_LHS_SCORE | CHANGE_RHS_SCORE | CHANGE_SWAP | CHANGE_LIMITS |
+                                          CHANGE_MODE | CHANGE_MATCH);
 
     dlog.info(TAG, "Starting server...");
     _server->start();
@@ -307,7 +354,7 @@ bool WebApp::writeFile(const char* base_name, const char* ext, uint8_t* data, si
     File f = _fs->open(name, "w");
     size_t written = f.write(data, len);
     f.close();
-    dlog.info(TAG, "WebApp::writeFile: name:'%s' len:%u written:%u", name.c_str(), len, written);
+    dlog.info(TAG, "WebApp::writeFile: name:'%s' len:%zu written:%zu", name.c_str(), len, written);
     return written == len;
 }
 
@@ -367,22 +414,35 @@ bool WebApp::generateCert(const char* base_file_name)
 
 void WebApp::addClient(ScoreboardClient* client)
 {
-    dlog.info(TAG, "addClient() before size: %u", _clients.size());
+    dlog.info(TAG, "addClient() before size: %zu", _clients.size());
     _clients.push_back(client);
-    dlog.info(TAG, "addClient() after size: %u", _clients.size());
+    dlog.info(TAG, "addClient() after size: %zu", _clients.size());
 }
 
 void WebApp::removeClient(ScoreboardClient* client)
 {
-    dlog.info(TAG, "removeClient() before size: %u", _clients.size());
+    dlog.info(TAG, "removeClient() before size: %zu", _clients.size());
     _clients.erase(std::remove(_clients.begin(), _clients.end(), client), _clients.end());
-    dlog.info(TAG, "removeClient() after size: %u", _clients.size());
+    dlog.info(TAG, "removeClient() after size: %zu", _clients.size());
+}
+
+/**
+ * Runs on the App task inside changeNotify(), so it only records the
+ * version, the WebApp task sends it to the clients.
+ */
+void WebApp::changed(const ScoreChanged& event)
+{
+    // the subscription filter already limits this to changes clients can see
+    _pending_version = event.version;
 }
 
+// on the WebApp task only, from task() or a client's message
 void WebApp::updateClients()
 {
-    dlog.info(TAG, "updateClients: clients: %d", _clients.size());
+    dlog.info(TAG, "updateClients: clients: %zu", _clients.size());
     App& app = App::getInstance();
+    _sent_version = app.version();
+    Score::State state = app.snapshot();
     const char* mode = "UNKNOWN";
     switch (app.mode())
     {
@@ -401,24 +461,33 @@ void WebApp::updateClients()
     }
     const char* lhs_color = "red";
     const char* rhs_color = "blue";
-    if (app.getTeam(Score::LHS) != Score::RED)
+    if (state.getTeam(Score::LHS) != Score::RED)
     {
         lhs_color = "blue";
         rhs_color = "red";
     }
     StaticJsonDocument<500> doc;
     doc["mode"] = mode;
+    doc["format"] = formatName(state.getFormat());
     JsonObject lhs = doc.createNestedObject("lhs");
     lhs["color"] = lhs_color;
-    lhs["score"] = app.getScore(Score::Side::LHS);
+    lhs["score"] = state.getScore(Score::Side::LHS);
     JsonObject rhs = doc.createNestedObject("rhs");
     rhs["color"] = rhs_color;
-    rhs["score"] = app.getScore(Score::Side::RHS);
+    rhs["score"] = state.getScore(Score::Side::RHS);
+    Match::State match = app.match();
+    JsonObject games = doc.createNestedObject("match");
+    games["game"]     = match.getGame() + 1;
+    games["best_of"]  = match.getBestOf();
+    games["red"]      = match.getGamesWon(Score::RED);
+    games["blue"]     = match.getGamesWon(Score::BLUE);
+    games["interval"] = match.isInterval();
+    games["over"]     = match.isMatchOver();
 
 
     for (ScoreboardClient* client : _clients)
     {
-        dlog.info(TAG, "updateClients: client: 0x%08x", client);
+        dlog.info(TAG, "updateClients: client: %p", client);
         if (client == nullptr)
         {
             continue;
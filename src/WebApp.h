@@ -34,6 +34,7 @@
 #include <HTTPResponse.hpp>
 #include <FS.h>
 #include "App.h"
+#include <atomic>
 #include <map>
 #include <vector>
 #include "Config.h"
@@ -62,6 +63,7 @@ public:
     void addClient(ScoreboardClient* client);
     void removeClient(ScoreboardClient* client);
     void updateClients();
+    void changed(const ScoreChanged& event);
 
     Config* getConfig();
     FS*     getFS();
@@ -71,7 +73,9 @@ private:
     FS* _fs;
     SSLCert * _cert;
     HTTPServer * _server;
-    std::vector<ScoreboardClient*> _clients;
+    std::vector<ScoreboardClient*> _clients;    // only touched on the WebApp task
+    std::atomic<uint32_t> _pending_version;     // newest App version published, set on the App task
+    uint32_t _sent_version;                     // App version last sent to clients
 
     WebApp();
     bool start();
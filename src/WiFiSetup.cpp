@@ -50,7 +50,7 @@ WiFiSetup::~WiFiSetup()
 {
 }
 
-void WiFiSetup::connect(bool force_config)
+bool WiFiSetup::connect(bool force_config)
 {
     dlog.info(TAG, F("connect: disableing captive portal when auto-connecting"));
     WiFi.mode(WIFI_MODE_STA);
@@ -61,18 +61,27 @@ void WiFiSetup::connect(bool force_config)
     if (force_config)
     {
         dlog.info(TAG, F("connect: starting forced config portal!"));
-        _wm.startConfigPortal(devicename.c_str(), nullptr);
+        if (!_wm.startConfigPortal(devicename.c_str(), nullptr))
+        {
+            return false;
+        }
     }
     else
     {
         dlog.info(TAG, F("connect: auto-connecting"));
-        while (!_wm.autoConnect())
+        for (int attempt = 1; !_wm.autoConnect(); ++attempt)
         {
+            if (attempt >= WIFI_CONNECT_ATTEMPTS)
+            {
+                dlog.error(TAG, "connect: not connected after %d attempts!", attempt);
+                return false;
+            }
             dlog.error(TAG, F("connect: not connected! retrying...."));
             delay(1000);
         }
     }
     WiFi.setSleep(false);
+    return true;
 }
 
 void WiFiSetup::startingPortal(WiFiManager* wmp)
@@ -94,7 +103,7 @@ void WiFiSetup::startingPortal(WiFiManager* wmp)
     // Update the display with the SSID to show portal is up
     //
     dlog.info(TAG, F("startingPortal: updating display"));
-    _display.message(_wm.getConfigPortalSSID().c_str());
+    _display.overlay(_wm.getConfigPortalSSID().c_str(), 0, OVERLAY_PRIORITY_ALERT);
 }
 
 void WiFiSetup::saveConfig()
@@ -33,11 +33,15 @@
 #include "Display.h"
 #include "Config.h"
 
+#ifndef WIFI_CONNECT_ATTEMPTS
+#define WIFI_CONNECT_ATTEMPTS 5
+#endif
+
 class WiFiSetup {
 public:
 	WiFiSetup(Config& config, Display& display, boolean debug);
 	virtual ~WiFiSetup();
-	void connect(bool force_config = false);
+	bool connect(bool force_config = false);
 	const String getHostname();
 	const String getEnablePassword();
 	bool    getStartWiFi();
@@ -27,13 +27,20 @@
  * 
  */
 #include "App.h"
+#include "Boot.h"
+#ifndef NATIVE_HAL
 #include "WebApp.h"
+#endif
 #include "Buttons.h"
 #include "Display.h"
+#include "SmartMatrixTarget.h"
+#include "ScoreJournal.h"
 #include <functional>
 #include <SPIFFS.h>
 #include "Config.h"
+#ifndef NATIVE_HAL
 #include "WiFiSetup.h"
+#endif
 #include "Log.h"
 #include "DLogPrintWriter.h"
 
@@ -42,20 +49,34 @@ const uint8_t SCORE_LHS_PIN  = 18;
 const uint8_t SCORE_SWAP_PIN = 19;
 
 static App& app = App::getInstance();
-static Display display(app);
+static SmartMatrixTarget panel;
+static Display display(app, panel);
 static Buttons buttons(app, SCORE_LHS_PIN, SCORE_RHS_PIN, SCORE_SWAP_PIN);
+static ScoreJournal journal(app, SPIFFS);
 
 DLog& dlog = DLog::getLog();
 Config config;
 
+#if CONFIG_FREERTOS_UNICORE
+#define ARDUINO_RUNNING_CORE 0
+#else
+#define ARDUINO_RUNNING_CORE 1
+#endif
+
+#ifndef WIFI_RETRY_MAX_MS
+#define WIFI_RETRY_MAX_MS 60000
+#endif
+
 #ifdef USE_NETWORK_BY_DEFAULT
 const bool DEFAULT_USE_NETWORK = true;
 #else
 const bool DEFAULT_USE_NETWORK = false;
 #endif
 
+// every memory usage point is also a boot profiler mark, see Boot
+#define MEMORY_USAGE(s)  Boot::getInstance().mark(s)
+
 #ifdef SHOW_MEMORY_USAGE
-#define MEMORY_USAGE(s)  printMemInfo(s)
 void printMemInfo(const char* label)
 {
     static const char* TAG = "printMemInfo";
@@ -65,8 +86,6 @@ void printMemInfo(const char* label)
     uint32_t largest_free = ESP.getMaxAllocHeap();
     dlog.info(TAG, "%s - size:%u free:%u largest:%u minfree:%u", label, heap_size, heap_free, largest_free, min_free);
 }
-#else
-#define MEMORY_USAGE(s) 
 #endif
 
 static void logTimeFirst(DLogBuffer& buffer, DLogLevel level)
@@ -75,121 +94,140 @@ static void logTimeFirst(DLogBuffer& buffer, DLogLevel level)
     const char* name = pcTaskGetTaskName(NULL);
     uint32_t core =  xPortGetCoreID();
     //buffer.printf("%1.3f ", millis()/1000.0);
-    buffer.printf("%010lu %u:%s ", millis(), core, name);
+    buffer.printf("%010lu %u:%s ", (unsigned long)millis(), core, name);
 }
 
-void initWiFi(bool force_config)
-{
-        MEMORY_USAGE("before WiFiSetup");
-        WiFiSetup wfs(config, display, true);
-        wfs.connect(force_config);
-    
-        MEMORY_USAGE("before WebApp");
-        display.message("WebApp");
-        WebApp& wapp = WebApp::getInstance();
-        wapp.begin(&config, &SPIFFS, "/scoreboard");
-}
+// read from the buttons held at power on
+typedef struct boot_options {
+    bool force_config;      // both side buttons, run the WiFi config portal
+    bool toggle_network;    // swap button, flip the start WiFi setting
+} BootOptions;
 
-void setup() {
-    static const char* TAG = "setup";
-    Serial.begin(115200);
-    dlog.begin(new DLogPrintWriter(Serial));
-    dlog.setPreFunc(&logTimeFirst);
-    delay(200);
-    dlog.info(TAG, "Starting!");
-    MEMORY_USAGE("setup");
+static BootOptions boot_options;
 
-    buttons.begin();
-
-    display.begin("Scoreboard 1.0");
-    app.mode(AppMode::STARTING);
-    display.render();
+/**
+ * Config, WiFi and the WebApp come up in their own task next to the game
+ * instead of in front of it.  WiFi keeps retrying here with a backoff.
+ */
+static void networkTask(void* data)
+{
+    static const char* TAG = "networkTask";
+    Boot& boot = Boot::getInstance();
+    const BootOptions* options = (const BootOptions*)data;
+    bool force_config = options->force_config;
 
-    MEMORY_USAGE("befor Config");
-    display.message("Config");
-    config.begin();
-    bool force_config = false;
     if (!config.load())
     {
         dlog.info(TAG, "config failed to load, forcing config if wifi enabled");
         force_config = true;
     }
-    MEMORY_USAGE("after Config");
+    boot.mark("config");
 
     bool start_network = DEFAULT_USE_NETWORK;
     if (config.getStartWiFi())
     {
         start_network = true;
     }
-
-    if (digitalRead(SCORE_LHS_PIN) == 0 && digitalRead(SCORE_RHS_PIN) == 0)
+    if (options->toggle_network)
     {
-        force_config = true;
+        start_network = !start_network;
     }
 
-    if (digitalRead(SCORE_SWAP_PIN) == 0)
+#ifdef NATIVE_HAL
+    // no WiFi or web server on the host, only the game runs
+    (void)start_network;
+    (void)force_config;
+#else
+    if (start_network)
     {
-        start_network = !start_network;
+        MEMORY_USAGE("before WiFiSetup");
+        WiFiSetup wfs(config, display, true);
+        uint32_t backoff = 1000;
+        while (!wfs.connect(force_config) && !force_config)
+        {
+            dlog.warning(TAG, "WiFi not connected, retrying in %u ms", backoff);
+            vTaskDelay(backoff / portTICK_PERIOD_MS);
+            backoff = min(backoff * 2, (uint32_t)WIFI_RETRY_MAX_MS);
+        }
+        boot.mark("wifi");
+
+        MEMORY_USAGE("before WebApp");
+        WebApp& wapp = WebApp::getInstance();
+        wapp.begin(&config, &SPIFFS, "/scoreboard");
+        boot.mark("webapp");
     }
+#endif
 
-    if (start_network)
+    // held back so the portal SSID stays on the panel
+    if (options->force_config)
     {
-        initWiFi(force_config);
+        app.started();
     }
+    vTaskDelete(NULL);
+}
+
+void setup() {
+    static const char* TAG = "setup";
+    Boot& boot = Boot::getInstance();
+    Serial.begin(115200);
+    dlog.begin(new DLogPrintWriter(Serial));
+    dlog.setPreFunc(&logTimeFirst);
+    dlog.info(TAG, "Starting!");
+    MEMORY_USAGE("setup");
+    boot.mark("serial");
+
+    app.begin();
+    buttons.begin();
+    boot.mark("tasks");
 
     //
-    // any app change notifies the display
+    // any app change notifies the display, from before the journal resumes
+    // a game so that change is rendered even if it lands after the first frame
     //
-    MEMORY_USAGE("before app.onChange");
-    app.onChange(std::bind(&Display::render, &display));
+    MEMORY_USAGE("before app.events().subscribe");
+    // limits are not shown on the panel
+    app.events().subscribe(Delegate<ScoreChanged>::bind<Display, &Display::changed>(&display),
+                           CHANGE_ALL & ~CHANGE_LIMITS);
+
+    // storage first so a saved game is in the very first frame
+    bool mounted = config.begin();
+    boot.mark("spiffs");
+    if (mounted)
+    {
+        MEMORY_USAGE("before ScoreJournal");
+        journal.begin();
+    }
+    boot.mark("journal");
+
+    display.begin("Scoreboard 1.0", !journal.resumed());
+    display.render();
+    boot.mark("display");
 
+    // the Buttons task may not have configured the pins yet
+    pinMode(SCORE_LHS_PIN, INPUT_PULLUP);
+    pinMode(SCORE_RHS_PIN, INPUT_PULLUP);
+    pinMode(SCORE_SWAP_PIN, INPUT_PULLUP);
+    boot_options.force_config   = digitalRead(SCORE_LHS_PIN) == 0 && digitalRead(SCORE_RHS_PIN) == 0;
+    boot_options.toggle_network = digitalRead(SCORE_SWAP_PIN) == 0;
+    xTaskCreatePinnedToCore(&networkTask, "Network", 10240, &boot_options, 1, NULL, ARDUINO_RUNNING_CORE);
+
+    if (!boot_options.force_config)
+    {
+        app.started();
+    }
+
+    boot.mark("setup");
     MEMORY_USAGE("setup done");
 }
 
 void loop()
 {
+    // everything is driven by the App, Buttons and Display tasks
 #ifdef SHOW_MEMORY_USAGE
-    static uint32_t last_memory_display = 0;
-    uint32_t now = millis();
-    if ((now - last_memory_display) > SHOW_MEMORY_USAGE)
-    {
-        MEMORY_USAGE("loop");
-        last_memory_display = now;
-    }
+    // periodic samples only go to the log so they don't push boot out of the ring
+    delay(SHOW_MEMORY_USAGE);
+    printMemInfo("loop");
+#else
+    vTaskDelay(portMAX_DELAY);
 #endif
-
-    // soft reset: hold swap for 10ish seconds
-    if (buttons.isReset())
-    {
-        ESP.restart();
-    }
-
-    switch (app.mode())
-    {
-    case AppMode::STARTING:
-        if (!display.isScrolling())
-        {
-            app.mode(AppMode::CHOOSING);
-        }
-        break;
-
-    case AppMode::CHOOSING:
-        // state change here happens in choice()
-        break;
-
-    case AppMode::RUNNING:
-        if (app.isGameOver())
-        {
-            app.mode(AppMode::GAME_OVER);
-        }
-        break;
-
-    case AppMode::GAME_OVER:
-        if (!app.isGameOver())
-        {
-            app.mode(AppMode::RUNNING);
-        }
-        break;
-    }
-    delay(1);
 }
@@ -0,0 +1,149 @@
+/**
+ * @file test_main.cpp
+ * @author Christoper B. Liebman
+ * @brief ButtonDebouncer fed with synthetic edge traces
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ *
+ * Run on the host with: pio test -e native
+ */
+#include <unity.h>
+#include "ButtonDebouncer.h"
+
+typedef struct trace_edge {
+    uint32_t when;
+    bool     pressed;
+} TraceEdge;
+
+/**
+ * Play the edges and poll update() every ms up to end, the way the Buttons
+ * task would if it woke every tick.  Returns the events or'ed together and
+ * the time of the first of each in at[].
+ */
+static uint8_t play(ButtonDebouncer& button, const TraceEdge* edges, size_t count, uint32_t end, uint32_t at[3] = nullptr)
+{
+    uint8_t events = ButtonDebouncer::NONE;
+    size_t  next   = 0;
+    for (uint32_t now = 0; now <= end; ++now)
+    {
+        while (next < count && edges[next].when == now)
+        {
+            button.edge(edges[next].pressed, now);
+            ++next;
+        }
+        uint8_t fired = button.update(now);
+        for (int i = 0; i < 3; ++i)
+        {
+            if (at && (fired & (1 << i)) && !(events & (1 << i)))
+            {
+                at[i] = now;
+            }
+        }
+        events |= fired;
+    }
+    return events;
+}
+
+static void test_bounce_only(void)
+{
+    // contact chatter that settles back to released is not a press
+    ButtonDebouncer button;
+    button.begin(false, 0);
+    const TraceEdge edges[] = {{100, true}, {103, false}, {108, true}, {110, false}, {121, true}, {125, false}};
+    TEST_ASSERT_EQUAL_UINT8(ButtonDebouncer::NONE, play(button, edges, 6, 2000));
+    TEST_ASSERT_FALSE(button.isPressed());
+}
+
+static void test_short_press(void)
+{
+    ButtonDebouncer button;
+    button.begin(false, 0);
+    const TraceEdge edges[] = {{100, true}, {102, false}, {104, true}, {300, false}, {301, true}, {303, false}};
+    uint32_t at[3] = {0, 0, 0};
+    TEST_ASSERT_EQUAL_UINT8(ButtonDebouncer::PRESS, play(button, edges, 6, 2000, at));
+    // reported once the release has been stable for the debounce time
+    TEST_ASSERT_EQUAL_UINT32(303 + BUTTON_DEBOUNCE_MS, at[0]);
+    TEST_ASSERT_FALSE(button.isPressed());
+}
+
+static void test_long_press(void)
+{
+    ButtonDebouncer button;
+    button.begin(false, 0);
+    const TraceEdge edges[] = {{100, true}, {101, false}, {102, true}, {1500, false}, {1502, true}, {1503, false}};
+    uint32_t at[3] = {0, 0, 0};
+    TEST_ASSERT_EQUAL_UINT8(ButtonDebouncer::LONG_PRESS, play(button, edges, 6, 3000, at));
+    // timed from the edge that started the stable press, no PRESS on release
+    TEST_ASSERT_EQUAL_UINT32(102 + BUTTON_LONG_PRESS_MS, at[1]);
+}
+
+static void test_very_long_press(void)
+{
+    ButtonDebouncer button;
+    button.begin(false, 0);
+    const TraceEdge edges[] = {{100, true}, {12000, false}};
+    uint32_t at[3] = {0, 0, 0};
+    TEST_ASSERT_EQUAL_UINT8(ButtonDebouncer::LONG_PRESS | ButtonDebouncer::HOLD, play(button, edges, 2, 11000, at));
+    TEST_ASSERT_EQUAL_UINT32(100 + BUTTON_LONG_PRESS_MS, at[1]);
+    TEST_ASSERT_EQUAL_UINT32(100 + BUTTON_HOLD_MS, at[2]);
+    // nothing left to time until it is released
+    TEST_ASSERT_EQUAL_UINT32(ButtonDebouncer::NO_DEADLINE, button.nextDeadline(11000));
+    TEST_ASSERT_EQUAL_UINT8(ButtonDebouncer::NONE, play(button, edges, 2, 13000));
+}
+
+static void test_held_at_begin(void)
+{
+    // a button down at startup is ignored until released
+    ButtonDebouncer button;
+    button.begin(true, 0);
+    const TraceEdge edges[] = {{5000, false}};
+    TEST_ASSERT_EQUAL_UINT8(ButtonDebouncer::NONE, play(button, edges, 1, 12000));
+}
+
+static void test_deadlines(void)
+{
+    ButtonDebouncer button;
+    button.begin(false, 0);
+    TEST_ASSERT_EQUAL_UINT32(ButtonDebouncer::NO_DEADLINE, button.nextDeadline(0));
+    button.edge(true, 100);
+    TEST_ASSERT_EQUAL_UINT32(BUTTON_DEBOUNCE_MS - 10, button.nextDeadline(110));
+    button.update(100 + BUTTON_DEBOUNCE_MS);
+    TEST_ASSERT_TRUE(button.isPressed());
+    TEST_ASSERT_EQUAL_UINT32(BUTTON_LONG_PRESS_MS - BUTTON_DEBOUNCE_MS, button.nextDeadline(100 + BUTTON_DEBOUNCE_MS));
+    TEST_ASSERT_EQUAL_UINT8(ButtonDebouncer::LONG_PRESS, button.update(100 + BUTTON_LONG_PRESS_MS));
+    TEST_ASSERT_EQUAL_UINT32(BUTTON_HOLD_MS - BUTTON_LONG_PRESS_MS, button.nextDeadline(100 + BUTTON_LONG_PRESS_MS));
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bounce_only);
+    RUN_TEST(test_short_press);
+    RUN_TEST(test_long_press);
+    RUN_TEST(test_very_long_press);
+    RUN_TEST(test_held_at_begin);
+    RUN_TEST(test_deadlines);
+    return UNITY_END();
+}
@@ -0,0 +1,197 @@
+/**
+ * @file test_main.cpp
+ * @author Christoper B. Liebman
+ * @brief FrameScheduler deadlines and EffectGovernor quality driven with synthetic timestamps
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ *
+ * Run on the host with: pio test -e native
+ */
+#include <unity.h>
+#include "FrameScheduler.h"
+
+#define PERIOD_US 1000
+
+// absolute time of the next deadline, it must not be behind now
+static uint32_t nextDeadline(const FrameScheduler& scheduler, uint32_t now)
+{
+    return now + scheduler.untilDeadline(now);
+}
+
+// run one frame from start to end and check the deadline it leaves behind
+static void frame(FrameScheduler& scheduler, uint32_t start, uint32_t end, uint32_t skipped, uint32_t deadline)
+{
+    scheduler.frameStart(start);
+    scheduler.frameEnd(end);
+    TEST_ASSERT_EQUAL_UINT32(skipped, scheduler.stats().skipped);
+    TEST_ASSERT_EQUAL_UINT32(deadline, nextDeadline(scheduler, end));
+}
+
+static void test_phase(void)
+{
+    // frames that start late or run long stay on the original phase
+    FrameScheduler scheduler(PERIOD_US);
+    scheduler.begin(500);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.untilDeadline(500));
+    frame(scheduler, 500, 800, 0, 1500);
+    frame(scheduler, 1550, 1900, 0, 2500);
+    TEST_ASSERT_EQUAL_UINT32(50, scheduler.stats().last_jitter_us);
+    frame(scheduler, 2500, 3400, 0, 3500);
+    TEST_ASSERT_EQUAL_UINT32(3, scheduler.stats().frames);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.stats().overruns);
+}
+
+static void test_late_zero(void)
+{
+    // ending exactly on the next deadline is on time
+    FrameScheduler scheduler(PERIOD_US);
+    scheduler.begin(0);
+    frame(scheduler, 0, PERIOD_US, 0, PERIOD_US);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.untilDeadline(PERIOD_US));
+    frame(scheduler, PERIOD_US, PERIOD_US + 100, 0, 2 * PERIOD_US);
+}
+
+static void test_late_one_us(void)
+{
+    FrameScheduler scheduler(PERIOD_US);
+    scheduler.begin(0);
+    frame(scheduler, 0, PERIOD_US + 1, 1, 2 * PERIOD_US);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.stats().overruns);
+}
+
+static void test_late_one_period(void)
+{
+    // the deadline after next is still on time, only the next one is missed
+    FrameScheduler scheduler(PERIOD_US);
+    scheduler.begin(0);
+    frame(scheduler, 0, 2 * PERIOD_US, 1, 2 * PERIOD_US);
+    frame(scheduler, 2 * PERIOD_US, 2 * PERIOD_US + 1 + PERIOD_US, 2, 4 * PERIOD_US);
+}
+
+static void test_late_several_periods(void)
+{
+    FrameScheduler scheduler(PERIOD_US);
+    scheduler.begin(0);
+    frame(scheduler, 0, 5 * PERIOD_US, 4, 5 * PERIOD_US);
+    frame(scheduler, 5 * PERIOD_US, 8 * PERIOD_US + 500, 7, 9 * PERIOD_US);
+    frame(scheduler, 9 * PERIOD_US, 9 * PERIOD_US + 200, 7, 10 * PERIOD_US);
+}
+
+static void test_wrap(void)
+{
+    // micros() wraps after ~71 minutes, the deadlines must not notice
+    FrameScheduler scheduler(PERIOD_US);
+    uint32_t start = 0xffffffff - 1500;
+    scheduler.begin(start);
+    frame(scheduler, start, start + 300, 0, start + PERIOD_US);
+    frame(scheduler, start + PERIOD_US, start + 3 * PERIOD_US + 1, 2, start + 4 * PERIOD_US);
+}
+
+#define BUDGET_US 1000
+
+static void test_governor_overrun(void)
+{
+    // each overrun cuts a quarter at once
+    EffectGovernor governor;
+    TEST_ASSERT_EQUAL_UINT32(EFFECT_QUALITY_FULL, governor.quality());
+    governor.update(BUDGET_US + 1, BUDGET_US);
+    TEST_ASSERT_EQUAL_UINT32(192, governor.quality());
+    governor.update(2 * BUDGET_US, BUDGET_US);
+    TEST_ASSERT_EQUAL_UINT32(144, governor.quality());
+    TEST_ASSERT_EQUAL_UINT32(2, governor.reductions());
+    // a frame that uses the whole budget is not an overrun
+    governor.update(BUDGET_US, BUDGET_US);
+    TEST_ASSERT_EQUAL_UINT32(144, governor.quality());
+    TEST_ASSERT_EQUAL_UINT32(2, governor.reductions());
+}
+
+static void test_governor_headroom(void)
+{
+    EffectGovernor governor;
+    governor.update(BUDGET_US + 1, BUDGET_US);
+    TEST_ASSERT_EQUAL_UINT32(192, governor.quality());
+    // at or over the headroom threshold the quality holds
+    uint32_t threshold = BUDGET_US / 100 * EFFECT_HEADROOM_PCT;
+    governor.update(threshold, BUDGET_US);
+    governor.update(BUDGET_US - 1, BUDGET_US);
+    TEST_ASSERT_EQUAL_UINT32(192, governor.quality());
+    // under it the quality comes back a step per frame
+    governor.update(threshold - 1, BUDGET_US);
+    TEST_ASSERT_EQUAL_UINT32(192 + EFFECT_QUALITY_STEP, governor.quality());
+    for (int i = 0; i < 3; ++i)
+    {
+        governor.update(0, BUDGET_US);
+    }
+    TEST_ASSERT_EQUAL_UINT32(192 + 4 * EFFECT_QUALITY_STEP, governor.quality());
+    TEST_ASSERT_EQUAL_UINT32(1, governor.reductions());
+}
+
+static void test_governor_clamp(void)
+{
+    // never below the minimum however many overruns
+    EffectGovernor governor;
+    for (int i = 0; i < 20; ++i)
+    {
+        governor.update(BUDGET_US + 1, BUDGET_US);
+        TEST_ASSERT_GREATER_OR_EQUAL(EFFECT_QUALITY_MIN, governor.quality());
+    }
+    TEST_ASSERT_EQUAL_UINT32(EFFECT_QUALITY_MIN, governor.quality());
+    TEST_ASSERT_EQUAL_UINT32(20, governor.reductions());
+
+    EffectGovernor floor(100);
+    for (int i = 0; i < 4; ++i)
+    {
+        floor.update(BUDGET_US + 1, BUDGET_US);
+    }
+    TEST_ASSERT_EQUAL_UINT32(100, floor.quality());
+
+    // and never above full, 108 does not land on it in whole steps
+    EffectGovernor ceiling;
+    for (int i = 0; i < 3; ++i)
+    {
+        ceiling.update(BUDGET_US + 1, BUDGET_US);
+    }
+    TEST_ASSERT_EQUAL_UINT32(108, ceiling.quality());
+    for (int i = 0; i < 30; ++i)
+    {
+        ceiling.update(0, BUDGET_US);
+    }
+    TEST_ASSERT_EQUAL_UINT32(EFFECT_QUALITY_FULL, ceiling.quality());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_phase);
+    RUN_TEST(test_late_zero);
+    RUN_TEST(test_late_one_us);
+    RUN_TEST(test_late_one_period);
+    RUN_TEST(test_late_several_periods);
+    RUN_TEST(test_wrap);
+    RUN_TEST(test_governor_overrun);
+    RUN_TEST(test_governor_headroom);
+    RUN_TEST(test_governor_clamp);
+    return UNITY_END();
+}
@@ -0,0 +1,20 @@
+// frame hashes for test/test_golden_frames/test_main.cpp, "record" rewrites this file
+#ifndef GOLDEN_FRAMES_H_
+#define GOLDEN_FRAMES_H_
+
+static const GoldenFrame golden_frames[] = {
+    {"starting", 0x227e21e4aee20d5bULL},
+    {"choosing", 0x26d018b64ecad486ULL},
+    {"running_0_0", 0xaeb80ac40f30befaULL},
+    {"running_7_3", 0xcf4e34dbafc02d7dULL},
+    {"running_swapped", 0x10e6ce4d34abb6feULL},
+    {"running_overlay", 0x4f967204b2d1b672ULL},
+    {"running_overlay_gone", 0xf38e797561762238ULL},
+    {"game_over_blink_off", 0xc0172f48c6c0400dULL},
+    {"game_over_blink_on", 0xe945a45fa769d5eeULL},
+    {"game_over_swapped_blink_off", 0x2b651a7e9834cc14ULL},
+    {"game_over_swapped_blink_on", 0x746f1a33d5f06e7dULL},
+    {"game_over_scroll", 0x86d1d337aaa656edULL},
+};
+
+#endif // GOLDEN_FRAMES_H_
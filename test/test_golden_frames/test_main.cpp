@@ -0,0 +1,296 @@
+/**
+ * @file test_main.cpp
+ * @author Christoper B. Liebman
+ * @brief host check of Display frames against stored hashes
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ *
+ * Run on the host with: pio test -e native
+ *
+ * or by hand from the top of the repo after a pio test build:
+ *
+ *   .pio/build/native/program [record|dump] [fixture file|ppm directory]
+ *
+ * The real App and Display run on the NativeHal virtual clock and draw into
+ * a FrameBufferTarget.  A script takes the App through every mode, both
+ * swap states and both game over blink phases and hashes the composed frame
+ * at fixed times.  The test compares the hashes with golden_frames.h and
+ * fails on any difference, "record" rewrites it after an intended change
+ * and "dump" writes each frame as a PPM.
+ *
+ * The twinkles come from the seeded PRNG so they are part of the frame: a
+ * change that only makes drawing faster must keep every hash, one that
+ * draws different pixels or uses the PRNG differently shows up here.
+ */
+#include <unity.h>
+#include <Arduino.h>
+#include <NativeHal.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "App.h"
+#include "Display.h"
+#include "FrameBufferTarget.h"
+#include "Log.h"
+
+struct GoldenFrame
+{
+    const char* name;
+    uint64_t    hash;
+};
+
+#include "golden_frames.h"
+
+#define GOLDEN_FIXTURE "test/test_golden_frames/golden_frames.h"
+
+struct Frame
+{
+    std::string name;
+    uint64_t    hash;
+};
+
+class GoldenFrames
+{
+public:
+    GoldenFrames(App& app, const char* mode, const char* path)
+    : _app(app),
+      _target(64, 32),
+      _display(app, _target),
+      _mode(mode),
+      _path(path),
+      _task(nullptr),
+      _mode_at(0),
+      _done(false),
+      _frames()
+    {
+    }
+
+    void begin()
+    {
+        _app.begin();
+        _display.begin("Scoreboard 1.0");
+        _app.events().subscribe(Delegate<ScoreChanged>::bind<Display, &Display::changed>(&_display),
+                                CHANGE_ALL & ~CHANGE_LIMITS);
+        _app.events().subscribe(Delegate<ModeChanged>::bind<GoldenFrames, &GoldenFrames::modeChange>(this));
+        xTaskCreatePinnedToCore(&taskGateway<GoldenFrames>, "Golden", 4096, this, 1, &_task, 1);
+        _app.started();
+    }
+
+    bool done() const { return _done; }
+    const std::vector<Frame>& frames() const { return _frames; }
+
+    // the fixture header with the hashes of this run
+    bool record()
+    {
+        FILE* file = fopen(_path.c_str(), "w");
+        if (file == nullptr)
+        {
+            perror(_path.c_str());
+            return false;
+        }
+        fprintf(file, "// frame hashes for test/test_golden_frames/test_main.cpp, \"record\" rewrites this file\n");
+        fprintf(file, "#ifndef GOLDEN_FRAMES_H_\n#define GOLDEN_FRAMES_H_\n\nstatic const GoldenFrame golden_frames[] = {\n");
+        for (const Frame& frame : _frames)
+        {
+            fprintf(file, "    {\"%s\", 0x%016llxULL},\n", frame.name.c_str(), (unsigned long long)frame.hash);
+        }
+        fprintf(file, "};\n\n#endif // GOLDEN_FRAMES_H_\n");
+        fclose(file);
+        printf("recorded %u frames to %s\n", (unsigned)_frames.size(), _path.c_str());
+        return true;
+    }
+
+    void report()
+    {
+        NativeHal::TaskStats stats[8];
+        size_t count = NativeHal::taskStats(stats, 8);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (strcmp(stats[i].name, "Display") == 0 && stats[i].host_us)
+            {
+                printf("display: %u frames in %.1f ms host, %.0f frames/s\n", _target.getShows(),
+                       stats[i].host_us / 1000.0, _target.getShows() * 1000000.0 / stats[i].host_us);
+            }
+        }
+    }
+
+private:
+    App&                _app;
+    FrameBufferTarget   _target;
+    Display             _display;
+    std::string         _mode;
+    std::string         _path;
+    TaskHandle_t        _task;
+    uint64_t            _mode_at;   // when the App last changed mode
+    volatile bool       _done;      // the script has run
+    std::vector<Frame>  _frames;
+
+    void modeChange(const ModeChanged& event)
+    {
+        _mode_at = NativeHal::now();
+        xTaskNotifyGive(_task);
+    }
+
+    void waitMode(AppMode mode)
+    {
+        while (_app.mode() != mode)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+
+    // the frame on the panel ms after when
+    void capture(const char* name, uint64_t when, uint32_t ms)
+    {
+        uint64_t at  = when + ms * 1000ULL;
+        uint64_t now = NativeHal::now();
+        if (at > now)
+        {
+            vTaskDelay((at - now) / 1000 / portTICK_PERIOD_MS);
+        }
+        _frames.push_back({name, _target.hash()});
+        if (_mode == "dump")
+        {
+            std::string path = _path + "/" + name + ".ppm";
+            if (!_target.writePPM(path.c_str()))
+            {
+                perror(path.c_str());
+            }
+        }
+    }
+
+    void points(Score::Side side, int count)
+    {
+        while (count-- > 0)
+        {
+            _app.incrementScore(side, 1);
+        }
+    }
+
+    void script()
+    {
+        capture("starting", 0, 500);
+        waitMode(AppMode::CHOOSING);
+        capture("choosing", _mode_at, 1000);
+
+        _app.setFormat(FORMAT_BADMINTON_21);
+        waitMode(AppMode::RUNNING);
+        capture("running_0_0", _mode_at, 100);
+        points(Score::LHS, 7);
+        points(Score::RHS, 3);
+        capture("running_7_3", NativeHal::now(), 100);
+        _app.swap();
+        capture("running_swapped", NativeHal::now(), 100);
+        _display.overlay("Hello", 1000);
+        capture("running_overlay", NativeHal::now(), 100);
+        capture("running_overlay_gone", NativeHal::now(), 1000);
+
+        // the blinker flips every 150 ms from the mode change, capture well inside a phase
+        points(Score::RHS, 14);
+        waitMode(AppMode::GAME_OVER);
+        uint64_t over = _mode_at;
+        capture("game_over_blink_off", over, 100);
+        capture("game_over_blink_on", over, 250);
+        _app.swap();
+        capture("game_over_swapped_blink_off", over, 400);
+        capture("game_over_swapped_blink_on", over, 550);
+        capture("game_over_scroll", over, 3000);
+    }
+
+    void task()
+    {
+        script();
+        _done = true;
+        while (true)
+        {
+            vTaskDelay(portMAX_DELAY);
+        }
+    }
+    friend void taskGateway<GoldenFrames>(void* data);
+};
+
+static GoldenFrames* golden = nullptr;
+
+static void test_frame_count(void)
+{
+    TEST_ASSERT_EQUAL_INT(sizeof(golden_frames) / sizeof(golden_frames[0]), golden->frames().size());
+}
+
+static void test_frames(void)
+{
+    int failed = 0;
+    for (const Frame& frame : golden->frames())
+    {
+        const GoldenFrame* expected = nullptr;
+        for (const GoldenFrame& g : golden_frames)
+        {
+            if (frame.name == g.name)
+            {
+                expected = &g;
+            }
+        }
+        bool ok = expected && expected->hash == frame.hash;
+        printf("%-28s %016llx %s\n", frame.name.c_str(), (unsigned long long)frame.hash,
+               ok ? "ok" : expected ? "MISMATCH" : "NEW");
+        failed += !ok;
+    }
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, failed, "frames differ from golden_frames.h, \"record\" after an intended change");
+}
+
+int main(int argc, char** argv)
+{
+    const char* mode = argc > 1 ? argv[1] : "check";
+    const char* path = argc > 2 ? argv[2] : strcmp(mode, "dump") == 0 ? "." : GOLDEN_FIXTURE;
+    if (strcmp(mode, "check") != 0 && strcmp(mode, "record") != 0 && strcmp(mode, "dump") != 0)
+    {
+        fprintf(stderr, "usage: %s [check|record|dump] [fixture file|ppm directory]\n", argv[0]);
+        return 2;
+    }
+
+    NativeHal::begin(true, 1);
+    dlog.setLevel(getenv("GOLDEN_VERBOSE") ? DLOG_LEVEL_DEBUG : DLOG_LEVEL_WARNING);
+    static GoldenFrames frames(App::getInstance(), mode, path);
+    golden = &frames;
+    golden->begin();
+    while (!golden->done())
+    {
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+    }
+
+    if (strcmp(mode, "record") == 0)
+    {
+        return golden->record() ? 0 : 1;
+    }
+    if (strcmp(mode, "dump") == 0)
+    {
+        printf("wrote %u frames to %s\n", (unsigned)golden->frames().size(), path);
+        return 0;
+    }
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_count);
+    RUN_TEST(test_frames);
+    golden->report();
+    return UNITY_END();
+}
@@ -0,0 +1,193 @@
+/**
+ * @file test_main.cpp
+ * @author Christoper B. Liebman
+ * @brief Journal against an in memory store that can fail
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ *
+ * Run on the host with: pio test -e native
+ */
+#include <unity.h>
+#include <string.h>
+#include "Journal.h"
+
+/**
+ * A store in RAM.  Writes fail while fail is set, a failing append still
+ * writes half of its data the way a reset part way through a flash write
+ * would.
+ */
+class MemoryJournalStore : public JournalStore
+{
+public:
+    MemoryJournalStore() : fail(false), _size(0), _data() {}
+    size_t size() override { return _size; }
+    size_t read(size_t offset, uint8_t* data, size_t len) override
+    {
+        if (offset >= _size)
+        {
+            return 0;
+        }
+        len = len < _size - offset ? len : _size - offset;
+        memcpy(data, _data + offset, len);
+        return len;
+    }
+    bool append(const uint8_t* data, size_t len) override
+    {
+        if (fail)
+        {
+            len /= 2;
+        }
+        if (_size + len > sizeof(_data))
+        {
+            return false;
+        }
+        memcpy(_data + _size, data, len);
+        _size += len;
+        return !fail;
+    }
+    bool sync() override { return !fail; }
+    bool rewrite(const uint8_t* data, size_t len) override
+    {
+        if (fail || len > sizeof(_data))
+        {
+            return false;
+        }
+        memcpy(_data, data, len);
+        _size = len;
+        return true;
+    }
+
+    bool fail;
+
+private:
+    size_t  _size;
+    uint8_t _data[4096];
+};
+
+// what a reset would restore from the store
+static uint32_t restored(MemoryJournalStore& store, size_t* records = nullptr)
+{
+    Journal       journal(store);
+    JournalRecord last;
+    TEST_ASSERT_TRUE_MESSAGE(journal.load(last), "nothing to restore");
+    if (records)
+    {
+        *records = journal.records();
+    }
+    return last.score;
+}
+
+static void test_commit_and_load(void)
+{
+    MemoryJournalStore store;
+    Journal journal(store);
+    journal.append(1, 0);
+    journal.append(2, 0);
+    journal.append(3, 0);
+    TEST_ASSERT_TRUE(journal.commit());
+    TEST_ASSERT_EQUAL_UINT32(0, journal.pending());
+    size_t records = 0;
+    TEST_ASSERT_EQUAL_UINT32(3, restored(store, &records));
+    TEST_ASSERT_EQUAL_UINT32(3, records);
+}
+
+static void test_failed_append_keeps_newest(void)
+{
+    MemoryJournalStore store;
+    Journal journal(store);
+    journal.append(1, 0);
+    TEST_ASSERT_TRUE(journal.commit());
+
+    // the append is torn mid record, the store still restores the last good one
+    store.fail = true;
+    journal.append(3, 0);
+    TEST_ASSERT_FALSE(journal.commit());
+    TEST_ASSERT_EQUAL_UINT32(1, journal.pending());
+    TEST_ASSERT_EQUAL_UINT32(1, restored(store));
+
+    // the retry, with no new change, compacts to a clean snapshot of the newest
+    store.fail = false;
+    uint32_t compactions = journal.compactions();
+    TEST_ASSERT_TRUE(journal.commit());
+    TEST_ASSERT_EQUAL_UINT32(0, journal.pending());
+    TEST_ASSERT_EQUAL_UINT32(compactions + 1, journal.compactions());
+    size_t records = 0;
+    TEST_ASSERT_EQUAL_UINT32(3, restored(store, &records));
+    TEST_ASSERT_EQUAL_UINT32(1, records);
+
+    // and appends carry on after the snapshot
+    journal.append(4, 0);
+    TEST_ASSERT_TRUE(journal.commit());
+    TEST_ASSERT_EQUAL_UINT32(4, restored(store, &records));
+    TEST_ASSERT_EQUAL_UINT32(2, records);
+}
+
+static void test_failed_compaction_retries(void)
+{
+    MemoryJournalStore store;
+    Journal journal(store);
+    journal.append(1, 0);
+    TEST_ASSERT_TRUE(journal.commit());
+
+    store.fail = true;
+    journal.append(2, 0);
+    TEST_ASSERT_FALSE(journal.commit());
+    // every retry while the store fails keeps the newest record, whatever arrives meanwhile
+    TEST_ASSERT_FALSE(journal.commit());
+    journal.append(5, 0);
+    TEST_ASSERT_FALSE(journal.commit());
+    TEST_ASSERT_EQUAL_UINT32(1, journal.pending());
+
+    store.fail = false;
+    TEST_ASSERT_TRUE(journal.commit());
+    TEST_ASSERT_EQUAL_UINT32(5, restored(store));
+}
+
+static void test_full_batch_while_failing(void)
+{
+    MemoryJournalStore store;
+    Journal journal(store);
+    store.fail = true;
+    // the kept record plus new ones fill the batch, the commit inside append() fails too
+    for (uint32_t score = 1; score <= 3 * JOURNAL_BATCH_SIZE; ++score)
+    {
+        journal.append(score, 0);
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(1, journal.pending());
+
+    store.fail = false;
+    TEST_ASSERT_TRUE(journal.commit());
+    TEST_ASSERT_EQUAL_UINT32(3 * JOURNAL_BATCH_SIZE, restored(store));
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_commit_and_load);
+    RUN_TEST(test_failed_append_keeps_newest);
+    RUN_TEST(test_failed_compaction_retries);
+    RUN_TEST(test_full_batch_while_failing);
+    return UNITY_END();
+}
@@ -0,0 +1,135 @@
+/**
+ * @file test_main.cpp
+ * @author Christoper B. Liebman
+ * @brief OverlayQueue priorities and eviction driven with synthetic millis
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ *
+ * Run on the host with: pio test -e native
+ */
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "OverlayQueue.h"
+
+static Overlay make(const char* text, uint8_t priority, uint32_t duration_ms = 1000)
+{
+    Overlay overlay;
+    memset(&overlay, 0, sizeof(overlay));
+    snprintf(overlay.text, sizeof(overlay.text), "%s", text);
+    overlay.duration_ms = duration_ms;
+    overlay.priority    = priority;
+    return overlay;
+}
+
+static const char* shown(OverlayQueue& queue, uint32_t now)
+{
+    const Overlay* overlay = queue.update(now);
+    return overlay ? overlay->text : "";
+}
+
+static void test_priority(void)
+{
+    // the highest priority is up, the newest wins a tie
+    OverlayQueue queue;
+    TEST_ASSERT_TRUE(queue.add(make("info", OVERLAY_PRIORITY_INFO), 0));
+    TEST_ASSERT_TRUE(queue.add(make("status", OVERLAY_PRIORITY_STATUS), 0));
+    TEST_ASSERT_TRUE(queue.add(make("info2", OVERLAY_PRIORITY_INFO), 0));
+    TEST_ASSERT_EQUAL_STRING("status", shown(queue, 0));
+    TEST_ASSERT_EQUAL_STRING("info2", shown(queue, 1000));
+}
+
+static void test_full_evicts_oldest_lowest(void)
+{
+    OverlayQueue queue;
+    TEST_ASSERT_TRUE(queue.add(make("status", OVERLAY_PRIORITY_STATUS), 0));
+    for (int i = 0; i < OVERLAY_SLOTS - 1; ++i)
+    {
+        char text[8];
+        snprintf(text, sizeof(text), "info%d", i);
+        TEST_ASSERT_TRUE(queue.add(make(text, OVERLAY_PRIORITY_INFO), 0));
+    }
+    // full, the oldest info makes room for a newer one
+    TEST_ASSERT_TRUE(queue.add(make("info9", OVERLAY_PRIORITY_INFO), 0));
+    TEST_ASSERT_EQUAL_STRING("status", shown(queue, 0));
+    const char* expect[] = {"info9", "info2", "info1"};
+    for (int i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT_EQUAL_STRING(expect[i], shown(queue, 1000 * (i + 1)));
+    }
+    TEST_ASSERT_EQUAL_STRING("", shown(queue, 4000));
+}
+
+static void test_full_keeps_alert(void)
+{
+    // the WiFi portal SSID must survive a stream of lower priority overlays
+    OverlayQueue queue;
+    for (int i = 0; i < OVERLAY_SLOTS - 1; ++i)
+    {
+        TEST_ASSERT_TRUE(queue.add(make("alert", OVERLAY_PRIORITY_ALERT, 10), 0));
+    }
+    TEST_ASSERT_TRUE(queue.add(make("portal", OVERLAY_PRIORITY_ALERT, 0), 0));
+    for (int i = 0; i < 10; ++i)
+    {
+        TEST_ASSERT_FALSE(queue.add(make("info", OVERLAY_PRIORITY_INFO), i));
+        TEST_ASSERT_FALSE(queue.add(make("status", OVERLAY_PRIORITY_STATUS), i));
+    }
+    // the newest alert is up, the timed ones run out and it stays
+    TEST_ASSERT_EQUAL_STRING("portal", shown(queue, 100));
+    TEST_ASSERT_EQUAL_STRING("portal", shown(queue, 100000));
+
+    // an equal priority overlay still replaces the oldest
+    OverlayQueue mixed;
+    TEST_ASSERT_TRUE(mixed.add(make("portal", OVERLAY_PRIORITY_ALERT, 0), 0));
+    for (int i = 0; i < OVERLAY_SLOTS - 1; ++i)
+    {
+        TEST_ASSERT_TRUE(mixed.add(make("status", OVERLAY_PRIORITY_STATUS), 0));
+    }
+    TEST_ASSERT_FALSE(mixed.add(make("info", OVERLAY_PRIORITY_INFO), 0));
+    TEST_ASSERT_TRUE(mixed.add(make("status2", OVERLAY_PRIORITY_STATUS), 0));
+    TEST_ASSERT_EQUAL_STRING("portal", shown(mixed, 0));
+}
+
+static void test_replaces_untimed(void)
+{
+    // an open ended overlay is replaced by anything at least as important
+    OverlayQueue queue;
+    TEST_ASSERT_TRUE(queue.add(make("connecting", OVERLAY_PRIORITY_STATUS, 0), 0));
+    TEST_ASSERT_TRUE(queue.add(make("info", OVERLAY_PRIORITY_INFO), 0));
+    TEST_ASSERT_EQUAL_STRING("connecting", shown(queue, 0));
+    TEST_ASSERT_TRUE(queue.add(make("connected", OVERLAY_PRIORITY_STATUS), 0));
+    TEST_ASSERT_EQUAL_STRING("connected", shown(queue, 0));
+    TEST_ASSERT_EQUAL_STRING("info", shown(queue, 1000));
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_priority);
+    RUN_TEST(test_full_evicts_oldest_lowest);
+    RUN_TEST(test_full_keeps_alert);
+    RUN_TEST(test_replaces_untimed);
+    return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/**
+ * @file test_main.cpp
+ * @author Christoper B. Liebman
+ * @brief score tables checked against the branchy rules for every score
+ * @version 0.1
+ * @date 2020-12-20
+ * 
+ * Copyright (c) 2020 Christoper B. Liebman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ *
+ *
+ * Run on the host with: pio test -e native
+ */
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "Score.h"
+
+/**
+ * Score::State::isGameOver() before the tables: nobody at the limit plays
+ * on, a 2 point lead wins, reaching the max limit wins.  Formats without a
+ * cap (max limit 0) came with the tables and only skip the last rule.
+ */
+static bool referenceGameOver(int limit, int max_limit, int red, int blue)
+{
+    if (red < limit && blue < limit)
+    {
+        return false;
+    }
+    if (abs(red - blue) > 1)
+    {
+        return true;
+    }
+    if (max_limit > 0 && (red >= max_limit || blue >= max_limit))
+    {
+        return true;
+    }
+    return false;
+}
+
+static Score::State makeState(ScoreFormat format, int limit, int max_limit, int red, int blue)
+{
+    return Score::State::fromPacked((uint32_t)red | (uint32_t)blue << 7 | (uint32_t)limit << 14 |
+                                    (uint32_t)max_limit << 21 | (uint32_t)format << 28);
+}
+
+// every score the packed state can hold, reachable or not
+static void checkAllScores(ScoreFormat format, int limit, int max_limit)
+{
+    char message[80];
+    for (int red = 0; red <= Score::State::SCORE_MASK; ++red)
+    {
+        for (int blue = 0; blue <= Score::State::SCORE_MASK; ++blue)
+        {
+            Score::State state = makeState(format, limit, max_limit, red, blue);
+            bool over = referenceGameOver(limit, max_limit, red, blue);
+            snprintf(message, sizeof(message), "format %d %d/%d at %d-%d", format, limit, max_limit, red, blue);
+            TEST_ASSERT_EQUAL_MESSAGE(over, state.isGameOver(), message);
+            TEST_ASSERT_EQUAL_MESSAGE(blue > red ? Score::BLUE : Score::RED, state.getLeader(), message);
+            TEST_ASSERT_EQUAL_MESSAGE(blue > red, (state.flags() & SCORE_BLUE_LEADS) != 0, message);
+            TEST_ASSERT_EQUAL_MESSAGE(!over && referenceGameOver(limit, max_limit, red + 1, blue),
+                                      state.isGamePoint(Score::RED), message);
+            TEST_ASSERT_EQUAL_MESSAGE(!over && referenceGameOver(limit, max_limit, red, blue + 1),
+                                      state.isGamePoint(Score::BLUE), message);
+        }
+    }
+}
+
+static void test_formats(void)
+{
+    for (int format = FORMAT_CUSTOM + 1; format < NUM_FORMATS; ++format)
+    {
+        checkAllScores((ScoreFormat)format, formatLimit((ScoreFormat)format), formatMaxLimit((ScoreFormat)format));
+    }
+}
+
+static void test_custom_limits(void)
+{
+    // the same limits as the tables but through ScoreRules, plus odd ones
+    static const int limits[][2] = {{21, 30}, {15, 20}, {11, 11}, {7, 9}, {1, 1}, {30, 127}};
+    for (size_t i = 0; i < sizeof(limits) / sizeof(limits[0]); ++i)
+    {
+        checkAllScores(FORMAT_CUSTOM, limits[i][0], limits[i][1]);
+    }
+}
+
+// the tables on their own, every cell against the rules
+template<int LIMIT, int MAX_LIMIT>
+static void checkTable()
+{
+    typedef ScoreTable<LIMIT, MAX_LIMIT> Table;
+    for (int red = 0; Table::contains(red, 0); ++red)
+    {
+        for (int blue = 0; Table::contains(red, blue); ++blue)
+        {
+            TEST_ASSERT_EQUAL(ScoreRules::flags(LIMIT, MAX_LIMIT, red, blue), Table::flags(red, blue));
+            TEST_ASSERT_EQUAL(referenceGameOver(LIMIT, MAX_LIMIT, red, blue), (Table::flags(red, blue) & SCORE_GAME_OVER) != 0);
+        }
+    }
+}
+
+static void test_tables(void)
+{
+    checkTable<21, 30>();
+    checkTable<15, 20>();
+    checkTable<15, 21>();
+    checkTable<11, 0>();
+    checkTable<25, 0>();
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_formats);
+    RUN_TEST(test_custom_limits);
+    RUN_TEST(test_tables);
+    return UNITY_END();
+}